@@ -0,0 +1,928 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Asynchronous Reads
+ *
+ * async_read.h
+ *
+ * Reading the data files ahead of the sort, many reads at a time, with io_uring
+ *
+ * One fetch thread copying one file ahead of the sorting threads only ever has
+ * one file's worth of reads waiting on the disk, and sits blocked while it does.
+ * A fast disk serves many requests at once, so here up to depth reads are kept
+ * in flight, for as many files ahead as that covers, and the sorting threads
+ * never wait on a file that has already come in
+ *
+ * async_reader is the read layer. Reads go to the kernel through an io_uring
+ * (set up with the raw system calls, no liburing): a read is a submission queue
+ * entry, and finished reads come back on the completion queue without a thread
+ * of ours blocking on them. If io_uring isn't there (old kernels, or turned off
+ * by a sandbox), one thread does the same reads with pread instead. Reads that
+ * come back short are sent again for the rest, so a finished read always has
+ * every byte asked for
+ *
+ * file_prefetch sits on top: a pool of reader threads, each with its own ring,
+ * takes files one at a time and reads binary ones straight into the array to
+ * sort, in ASYNC_CHUNK pieces. Files that can't be read as they are (text files,
+ * another key type, the other byte order) are loaded with dataFileLoad by the
+ * reader that takes them, while its reads for other files carry on. A file is
+ * only open while its reads are in flight, so any number of files can be
+ * prefetched
+ *
+ * What comes in is handed on a block at a time, not a file at a time: the files
+ * are cut into blocks of a fixed number of numbers (dataFilesBlocks), no read
+ * crosses from one block to the next, and every block that is all in goes on a
+ * bounded queue (fetch_queue.h) straight away. The sort takes whichever comes
+ * first, so it starts on the front of a huge file while the rest of it is still
+ * on the disk, and one slow file holds up only itself, not the files behind it
+ *
+ * Methods:
+ *  - asyncReaderInit(async_reader* reader, int depth, bool ring) -> void
+ *      Sets up a reader for depth reads in flight, with io_uring if ring and the
+ *      kernel has it, with a pread thread otherwise
+ *
+ *  - asyncReaderSubmit(async_reader* reader, int fd, off_t offset, void* buffer,
+ *                      size_t bytes, uint64_t tag) -> void
+ *      Starts reading bytes at offset of fd into buffer. There must be room
+ *
+ *  - asyncReaderFull(const async_reader* reader) -> bool
+ *      Whether depth reads are already in flight
+ *
+ *  - asyncReaderWait(async_reader* reader) -> uint64_t
+ *      Waits for a read to finish completely, returns its tag
+ *
+ *  - asyncReaderDestroy(async_reader* reader) -> void
+ *      Stops the reader, every read must be finished
+ *
+ *  - asyncRingSetup(async_reader* reader) -> bool
+ *      Creates and maps the io_uring, false if it can't
+ *
+ *  - asyncIssue(async_reader* reader, int slot) -> void
+ *      Hands a read (or what's left of it) to the ring or the thread
+ *
+ *  - asyncThreadMain(void* arg) -> void*
+ *      Pthread function
+ *      The pread thread: takes queued reads, reads them whole, hands them back
+ *
+ *  - asyncReadOptions(int argc, const char* argv[], int* depth, int* readers, size_t* block) -> int
+ *      Takes "--inflight n", "--readers n" and "--block n" (or "--inflight=n", ...) out
+ *      of the arguments, returns the new argc. They are ASYNC_DEFAULT_DEPTH,
+ *      ASYNC_DEFAULT_READERS and ASYNC_DEFAULT_BLOCK if they aren't there
+ *
+ *  - asyncReadNumber(const char* program, const char* option, const char* value) -> unsigned long long
+ *      The number an option was given, a usage error (the program exits) if it is
+ *      missing or isn't one
+ *
+ *  - filePrefetchStart_<type>(file_prefetch* prefetch, data_file* files, int total, T* array,
+ *                             const size_t* blockStarts, const int* firstBlock, int depth,
+ *                             int readers) -> void
+ *      Starts readers threads reading every file into the array, block b at
+ *      blockStarts[b], each with depth reads in flight
+ *
+ *  - filePrefetchNext(file_prefetch* prefetch) -> int
+ *      Waits for a block to be all in the array and returns which one
+ *
+ *  - filePrefetchFinish(file_prefetch* prefetch) -> void
+ *      Joins the readers and cleans up, once every block has been taken
+ *
+ *  - filePrefetchThread_<type>(void* arg) -> void*
+ *      Pthread function
+ *      One reader: takes files and asks for their reads, loads the ones that can't
+ *      be read directly, and queues every block that is all in
+ *
+ *  - filePrefetchInit, filePrefetchDirect, filePrefetchPump, filePrefetchCollect
+ *      The untyped parts: setting up, whether a file can be read straight into the
+ *      array, asking for more reads, handling one finished read
+ *
+ * Resources:
+ *  - Jens Axboe, "Efficient IO with io_uring" (2019)
+ *      the ring layout and setting it up without liburing
+ *  - io_uring_setup(2), io_uring_enter(2)
+ */
+#ifndef ASYNC_READ_H
+#define ASYNC_READ_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "data_files.h"
+#include "fetch_queue.h"
+
+#define ASYNC_CHUNK (1 << 20) //bytes asked for by one read
+#define ASYNC_DEFAULT_DEPTH 16 //reads kept in flight by each reader
+#define ASYNC_DEFAULT_READERS 2 //reader threads
+#define ASYNC_READY_BLOCKS 64 //blocks read in that can wait for the sort at once
+#define ASYNC_DEFAULT_BLOCK (1 << 16) //numbers handed to the sort as one piece
+
+//one read, from being asked for until every byte is in
+typedef struct {
+    int fd;
+    off_t offset;
+    char* buffer;
+    size_t bytes; //still to read
+    uint64_t tag; //the caller's, handed back when it's done
+    struct iovec vector; //what the ring reads into, has to outlive the submission
+} async_request;
+
+typedef struct {
+    int depth;
+    int inFlight;
+    async_request* requests; //depth of them
+    int* freeSlots; //requests not in use, a stack
+    int freeCount;
+    bool ring; //io_uring, or else the pread thread
+
+    //io_uring
+    int ringFd;
+    void* sqMap;
+    size_t sqMapLength;
+    void* cqMap;
+    size_t cqMapLength;
+    struct io_uring_sqe* sqes;
+    size_t sqesLength;
+    atomic_uint* sqTail;
+    unsigned sqMask;
+    unsigned* sqArray;
+    atomic_uint* cqHead;
+    atomic_uint* cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe* cqes;
+
+    //pread thread
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    int* queue; //reads waiting for the thread, circular, depth of them
+    int queueHead;
+    int queued;
+    int* finished; //reads the thread is done with
+    int finishedCount;
+    bool shutdown;
+} async_reader;
+
+/**
+ * Creates the io_uring and maps its two queues and its submission entries
+ *
+ * @param reader: the reader, gets the ring's file descriptor and queues
+ * @return bool: false if the kernel won't make one
+ */
+static inline bool asyncRingSetup(async_reader* reader){
+
+    struct io_uring_params params;
+    char* sq;
+    char* cq;
+
+    memset(&params, 0, sizeof(params));
+    reader->ringFd = (int) syscall(__NR_io_uring_setup, reader->depth, &params);
+
+    if (reader->ringFd < 0){
+        return false;
+    }//if
+
+    reader->sqMapLength = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    reader->cqMapLength = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    //newer kernels put both queues in one mapping
+    if (params.features & IORING_FEAT_SINGLE_MMAP){
+        if (reader->cqMapLength > reader->sqMapLength){
+            reader->sqMapLength = reader->cqMapLength;
+        }//if
+        reader->cqMapLength = reader->sqMapLength;
+    }//if
+
+    reader->sqMap = mmap(NULL, reader->sqMapLength, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, reader->ringFd, IORING_OFF_SQ_RING);
+    reader->cqMap = reader->sqMap;
+
+    if (reader->sqMap != MAP_FAILED && !(params.features & IORING_FEAT_SINGLE_MMAP)){
+        reader->cqMap = mmap(NULL, reader->cqMapLength, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, reader->ringFd, IORING_OFF_CQ_RING);
+    }//if
+
+    reader->sqesLength = params.sq_entries * sizeof(struct io_uring_sqe);
+    reader->sqes = mmap(NULL, reader->sqesLength, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, reader->ringFd, IORING_OFF_SQES);
+
+    if (reader->sqMap == MAP_FAILED || reader->cqMap == MAP_FAILED || reader->sqes == MAP_FAILED){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    sq = (char *) reader->sqMap;
+    cq = (char *) reader->cqMap;
+    reader->sqTail = (atomic_uint *) (sq + params.sq_off.tail);
+    reader->sqMask = *(unsigned *) (sq + params.sq_off.ring_mask);
+    reader->sqArray = (unsigned *) (sq + params.sq_off.array);
+    reader->cqHead = (atomic_uint *) (cq + params.cq_off.head);
+    reader->cqTail = (atomic_uint *) (cq + params.cq_off.tail);
+    reader->cqMask = *(unsigned *) (cq + params.cq_off.ring_mask);
+    reader->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+    return true;
+
+}//asyncRingSetup
+
+/**
+ * Pthread Function
+ *
+ * The fallback when there is no io_uring: reads every queued request whole with
+ * pread and hands it back, until the reader shuts down
+ *
+ * @param arg: the reader
+ * @return void*
+ */
+static void* asyncThreadMain(void* arg){
+
+    async_reader* reader = (async_reader *) arg;
+    async_request* request;
+    ssize_t got;
+    int slot;
+
+    pthread_mutex_lock(&reader->lock);
+
+    while (true){
+
+        while (reader->queued == 0 && !reader->shutdown){
+            pthread_cond_wait(&reader->work, &reader->lock);
+        }//while
+
+        if (reader->queued == 0){
+            break;
+        }//if
+
+        slot = reader->queue[reader->queueHead];
+        reader->queueHead = (reader->queueHead + 1) % reader->depth;
+        reader->queued--;
+        pthread_mutex_unlock(&reader->lock);
+
+        //the read itself happens without the lock
+        request = &reader->requests[slot];
+
+        while (request->bytes > 0){
+
+            got = pread(request->fd, request->buffer, request->bytes, request->offset);
+
+            if (got < 0 && errno == EINTR){
+                continue;
+            }//if
+
+            if (got <= 0){
+                fprintf(stderr, "Couldn't read a data file: %s\n", got < 0 ? strerror(errno) : "it ended early");
+                exit(EXIT_FAILURE);
+            }//if
+
+            request->buffer += got;
+            request->offset += got;
+            request->bytes -= got;
+
+        }//while
+
+        pthread_mutex_lock(&reader->lock);
+        reader->finished[reader->finishedCount++] = slot;
+        pthread_cond_signal(&reader->done);
+
+    }//while
+
+    pthread_mutex_unlock(&reader->lock);
+
+    return NULL;
+
+}//asyncThreadMain
+
+/**
+ * @param reader: the reader to set up
+ * @param depth: most reads in flight at once
+ * @param ring: whether to try io_uring first
+ * @return void
+ */
+static inline void asyncReaderInit(async_reader* reader, int depth, bool ring){
+
+    reader->depth = (depth > 0) ? depth : 1;
+    reader->inFlight = 0;
+    reader->requests = malloc(sizeof(async_request) * reader->depth);
+    reader->freeSlots = malloc(sizeof(int) * reader->depth);
+
+    if (reader->requests == NULL || reader->freeSlots == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the reader\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    for (int i = 0 ; i < reader->depth ; i++){
+        reader->freeSlots[i] = reader->depth - 1 - i;
+    }//for
+
+    reader->freeCount = reader->depth;
+    reader->ring = ring && asyncRingSetup(reader);
+
+    if (!reader->ring){
+
+        reader->queue = malloc(sizeof(int) * reader->depth);
+        reader->finished = malloc(sizeof(int) * reader->depth);
+
+        if (reader->queue == NULL || reader->finished == NULL){
+            fprintf(stderr, "Couldn't allocate memory for the reader\n");
+            exit(EXIT_FAILURE);
+        }//if
+
+        reader->queueHead = 0;
+        reader->queued = 0;
+        reader->finishedCount = 0;
+        reader->shutdown = false;
+        pthread_mutex_init(&reader->lock, NULL);
+        pthread_cond_init(&reader->work, NULL);
+        pthread_cond_init(&reader->done, NULL);
+        pthread_create(&reader->thread, NULL, asyncThreadMain, reader);
+
+    }//if
+
+}//asyncReaderInit
+
+/**
+ * Hands a request to the kernel (or the pread thread) for the bytes it still needs
+ *
+ * @param reader: the reader
+ * @param slot: which request
+ * @return void
+ */
+static inline void asyncIssue(async_reader* reader, int slot){
+
+    async_request* request = &reader->requests[slot];
+    struct io_uring_sqe* entry;
+    unsigned tail;
+
+    if (!reader->ring){
+        pthread_mutex_lock(&reader->lock);
+        reader->queue[(reader->queueHead + reader->queued) % reader->depth] = slot;
+        reader->queued++;
+        pthread_cond_signal(&reader->work);
+        pthread_mutex_unlock(&reader->lock);
+        return;
+    }//if
+
+    //never more than depth in flight, so there is always a free entry
+    tail = atomic_load_explicit(reader->sqTail, memory_order_relaxed);
+    entry = &reader->sqes[tail & reader->sqMask];
+    memset(entry, 0, sizeof(*entry));
+
+    request->vector.iov_base = request->buffer;
+    request->vector.iov_len = request->bytes;
+    entry->opcode = IORING_OP_READV;
+    entry->fd = request->fd;
+    entry->off = request->offset;
+    entry->addr = (uint64_t) (uintptr_t) &request->vector;
+    entry->len = 1;
+    entry->user_data = slot;
+
+    reader->sqArray[tail & reader->sqMask] = tail & reader->sqMask;
+    atomic_store_explicit(reader->sqTail, tail + 1, memory_order_release);
+
+    while (syscall(__NR_io_uring_enter, reader->ringFd, 1, 0, 0, NULL, 0) < 0){
+        if (errno != EINTR && errno != EAGAIN){
+            perror("Error");
+            exit(EXIT_FAILURE);
+        }//if
+    }//while
+
+}//asyncIssue
+
+/**
+ * @param reader: the reader, must not be full
+ * @param fd: file to read
+ * @param offset: where in the file to start
+ * @param buffer: where the bytes go
+ * @param bytes: how many to read, the file must have them
+ * @param tag: handed back by asyncReaderWait when they're all in
+ * @return void
+ */
+static inline void asyncReaderSubmit(async_reader* reader, int fd, off_t offset, void* buffer,
+        size_t bytes, uint64_t tag){
+
+    int slot = reader->freeSlots[--reader->freeCount];
+    async_request* request = &reader->requests[slot];
+
+    request->fd = fd;
+    request->offset = offset;
+    request->buffer = (char *) buffer;
+    request->bytes = bytes;
+    request->tag = tag;
+    reader->inFlight++;
+
+    asyncIssue(reader, slot);
+
+}//asyncReaderSubmit
+
+/**
+ * @param reader: the reader
+ * @return bool: true if no more reads can be submitted until one finishes
+ */
+static inline bool asyncReaderFull(const async_reader* reader){
+    return reader->inFlight == reader->depth;
+}//asyncReaderFull
+
+/**
+ * Waits until one of the reads in flight has all its bytes. Reads that come back
+ * short are sent again for the rest in the meantime
+ *
+ * @param reader: the reader, with at least one read in flight
+ * @return uint64_t: the tag of the finished read
+ */
+static inline uint64_t asyncReaderWait(async_reader* reader){
+
+    async_request* request;
+    struct io_uring_cqe* completion;
+    unsigned head;
+    int slot, result;
+
+    while (true){
+
+        if (!reader->ring){
+            pthread_mutex_lock(&reader->lock);
+            while (reader->finishedCount == 0){
+                pthread_cond_wait(&reader->done, &reader->lock);
+            }//while
+            slot = reader->finished[--reader->finishedCount];
+            pthread_mutex_unlock(&reader->lock);
+            request = &reader->requests[slot];
+        }//if
+
+        else{
+
+            head = atomic_load_explicit(reader->cqHead, memory_order_relaxed);
+
+            //nothing finished yet, sleep in the kernel until something is
+            if (head == atomic_load_explicit(reader->cqTail, memory_order_acquire)){
+                if (syscall(__NR_io_uring_enter, reader->ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+                        && errno != EINTR){
+                    perror("Error");
+                    exit(EXIT_FAILURE);
+                }//if
+                continue;
+            }//if
+
+            completion = &reader->cqes[head & reader->cqMask];
+            slot = (int) completion->user_data;
+            result = completion->res;
+            atomic_store_explicit(reader->cqHead, head + 1, memory_order_release);
+            request = &reader->requests[slot];
+
+            if (result == -EINTR || result == -EAGAIN){
+                asyncIssue(reader, slot);
+                continue;
+            }//if
+
+            if (result <= 0){
+                fprintf(stderr, "Couldn't read a data file: %s\n",
+                    result < 0 ? strerror(-result) : "it ended early");
+                exit(EXIT_FAILURE);
+            }//if
+
+            request->buffer += result;
+            request->offset += result;
+            request->bytes -= result;
+
+            //short read, ask for the rest
+            if (request->bytes > 0){
+                asyncIssue(reader, slot);
+                continue;
+            }//if
+
+        }//else
+
+        reader->freeSlots[reader->freeCount++] = slot;
+        reader->inFlight--;
+
+        return request->tag;
+
+    }//while
+
+}//asyncReaderWait
+
+/**
+ * @param reader: the reader to stop, with nothing in flight
+ * @return void
+ */
+static inline void asyncReaderDestroy(async_reader* reader){
+
+    if (reader->ring){
+        munmap(reader->sqes, reader->sqesLength);
+        if (reader->cqMap != reader->sqMap){
+            munmap(reader->cqMap, reader->cqMapLength);
+        }//if
+        munmap(reader->sqMap, reader->sqMapLength);
+        close(reader->ringFd);
+    }//if
+
+    else{
+        pthread_mutex_lock(&reader->lock);
+        reader->shutdown = true;
+        pthread_cond_signal(&reader->work);
+        pthread_mutex_unlock(&reader->lock);
+        pthread_join(reader->thread, NULL);
+        pthread_mutex_destroy(&reader->lock);
+        pthread_cond_destroy(&reader->work);
+        pthread_cond_destroy(&reader->done);
+        free(reader->queue);
+        free(reader->finished);
+    }//else
+
+    free(reader->requests);
+    free(reader->freeSlots);
+
+}//asyncReaderDestroy
+
+/**
+ * @param program: the program's name, for the message
+ * @param option: the option the value was given for
+ * @param value: what came after it, NULL if nothing did
+ * @return unsigned long long: the number
+ */
+static inline unsigned long long asyncReadNumber(const char* program, const char* option, const char* value){
+
+    char* end;
+    unsigned long long number;
+
+    if (value == NULL){
+        fprintf(stderr, "usage:   %s ... %s n, n is missing\n", program, option);
+        exit(EXIT_FAILURE);
+    }//if
+
+    number = strtoull(value, &end, 10);
+
+    if (end == value || *end != '\0'){
+        fprintf(stderr, "usage:   %s ... %s n, n has to be a number, not \"%s\"\n", program, option, value);
+        exit(EXIT_FAILURE);
+    }//if
+
+    return number;
+
+}//asyncReadNumber
+
+/**
+ * Looks for "--inflight n", "--readers n" and "--block n" (or "--inflight=n",
+ * "--readers=n", "--block=n") among the arguments and removes them. One at the
+ * end, or with something that isn't a number, is reported and the program exits
+ *
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given, the options are taken out
+ * @param depth: set to the reads in flight per reader, or ASYNC_DEFAULT_DEPTH
+ * @param readers: set to the reader threads, or ASYNC_DEFAULT_READERS
+ * @param block: set to the numbers per block, or ASYNC_DEFAULT_BLOCK (0 for whole files)
+ * @return int: argc without the options
+ */
+static inline int asyncReadOptions(int argc, const char* argv[], int* depth, int* readers, size_t* block){
+
+    const char* depthValue = NULL;
+    const char* readersValue = NULL;
+    const char* blockValue = NULL;
+    int kept = 1;
+
+    for (int i = 1 ; i < argc ; i++){
+
+        if (strcmp(argv[i], "--inflight") == 0){
+            depthValue = (i + 1 < argc) ? argv[++i] : NULL;
+            asyncReadNumber(argv[0], "--inflight", depthValue);
+        }//if
+
+        else if (strncmp(argv[i], "--inflight=", 11) == 0){
+            depthValue = argv[i] + 11;
+            asyncReadNumber(argv[0], "--inflight", depthValue);
+        }//else if
+
+        else if (strcmp(argv[i], "--readers") == 0){
+            readersValue = (i + 1 < argc) ? argv[++i] : NULL;
+            asyncReadNumber(argv[0], "--readers", readersValue);
+        }//else if
+
+        else if (strncmp(argv[i], "--readers=", 10) == 0){
+            readersValue = argv[i] + 10;
+            asyncReadNumber(argv[0], "--readers", readersValue);
+        }//else if
+
+        else if (strcmp(argv[i], "--block") == 0){
+            blockValue = (i + 1 < argc) ? argv[++i] : NULL;
+            asyncReadNumber(argv[0], "--block", blockValue);
+        }//else if
+
+        else if (strncmp(argv[i], "--block=", 8) == 0){
+            blockValue = argv[i] + 8;
+            asyncReadNumber(argv[0], "--block", blockValue);
+        }//else if
+
+        else{
+            argv[kept++] = argv[i];
+        }//else
+
+    }//for
+
+    *depth = (depthValue != NULL) ? (int) strtol(depthValue, NULL, 10) : ASYNC_DEFAULT_DEPTH;
+    *readers = (readersValue != NULL) ? (int) strtol(readersValue, NULL, 10) : ASYNC_DEFAULT_READERS;
+    *block = (blockValue != NULL) ? (size_t) strtoull(blockValue, NULL, 10) : ASYNC_DEFAULT_BLOCK;
+
+    if (*depth < 1){
+        *depth = 1;
+    }//if
+
+    if (*readers < 1){
+        *readers = 1;
+    }//if
+
+    argv[kept] = NULL;
+
+    return kept;
+
+}//asyncReadOptions
+
+//reading every data file into the array to sort, ahead of the sort, by a pool of readers
+typedef struct file_prefetch file_prefetch;
+
+//one reader thread, with a ring of its own
+typedef struct {
+    async_reader reader;
+    file_prefetch* prefetch;
+    pthread_t thread;
+    int file; //the file whose reads are being asked for, -1 if none
+    int block; //the block of it whose reads are being asked for
+    size_t nextByte; //how much of the file has been asked for
+} file_reader;
+
+struct file_prefetch {
+    data_file* files;
+    int total;
+    char* array; //where the numbers go, as bytes
+    const size_t* blockStarts; //block b goes at blockStarts[b]
+    const int* firstBlock; //file i is blocks [firstBlock[i], firstBlock[i + 1])
+    size_t keySize;
+    int keyType;
+    atomic_int nextFile; //first file no reader has taken yet
+    int* fds; //open while a file's reads are in flight, -1 otherwise
+    int* waiting; //reads of each file not back yet, only touched by its reader
+    int* blockWaiting; //the same for each block
+    fetch_queue ready; //blocks in the array that the sort hasn't taken yet
+    file_reader* readers;
+    int readerCount;
+};
+
+/**
+ * @param prefetch: the prefetcher
+ * @param file: which file
+ * @return bool: whether it can be read straight into the array (binary, the key
+ *               type and this machine's byte order)
+ */
+static inline bool filePrefetchDirect(const file_prefetch* prefetch, int file){
+
+    const data_file* f = &prefetch->files[file];
+
+    return f->map != NULL && f->type == prefetch->keyType && !f->swapped;
+
+}//filePrefetchDirect
+
+/**
+ * Asks for as many more reads as the reader has room for, taking new files as
+ * it goes. A file that can't be read straight into the array (or is empty) is
+ * handed back instead, to be loaded on the spot
+ *
+ * @param reader: the reader thread's state
+ * @return int: a file to load, -1 if the ring is full or there are no files left
+ */
+static inline int filePrefetchPump(file_reader* reader){
+
+    file_prefetch* prefetch = reader->prefetch;
+    int file, block;
+    size_t fileStart, bytes, blockEnd, chunk;
+
+    while (!asyncReaderFull(&reader->reader)){
+
+        if (reader->file < 0){
+
+            file = atomic_fetch_add(&prefetch->nextFile, 1);
+
+            if (file >= prefetch->total){
+                return -1;
+            }//if
+
+            if (!filePrefetchDirect(prefetch, file) || prefetch->files[file].count == 0){
+                return file;
+            }//if
+
+            prefetch->fds[file] = open(prefetch->files[file].name, O_RDONLY);
+
+            if (prefetch->fds[file] < 0){
+                perror(prefetch->files[file].name);
+                exit(EXIT_FAILURE);
+            }//if
+
+            reader->file = file;
+            reader->block = prefetch->firstBlock[file];
+            reader->nextByte = 0;
+
+        }//if
+
+        file = reader->file;
+        block = reader->block;
+        fileStart = prefetch->blockStarts[prefetch->firstBlock[file]];
+        bytes = prefetch->files[file].count * prefetch->keySize;
+        blockEnd = (prefetch->blockStarts[block + 1] - fileStart) * prefetch->keySize;
+
+        //never past the end of the block, so a block is in once its own reads are
+        chunk = (blockEnd - reader->nextByte < ASYNC_CHUNK) ? blockEnd - reader->nextByte : ASYNC_CHUNK;
+
+        asyncReaderSubmit(&reader->reader, prefetch->fds[file],
+            (off_t) (sizeof(data_header) + reader->nextByte),
+            &prefetch->array[fileStart * prefetch->keySize + reader->nextByte],
+            chunk, ((uint64_t) file << 32) | (uint32_t) block);
+
+        prefetch->waiting[file]++;
+        prefetch->blockWaiting[block]++;
+        reader->nextByte += chunk;
+
+        if (reader->nextByte == bytes){
+            reader->file = -1;
+            reader->block = -1;
+        }//if
+
+        else if (reader->nextByte == blockEnd){
+            reader->block++;
+        }//else if
+
+    }//while
+
+    return -1;
+
+}//filePrefetchPump
+
+/**
+ * Waits for one of the reader's reads, hands its block to the sort if that was
+ * the block's last one, and closes its file if it was the file's
+ *
+ * @param reader: the reader thread's state, with reads in flight
+ * @return void
+ */
+static inline void filePrefetchCollect(file_reader* reader){
+
+    file_prefetch* prefetch = reader->prefetch;
+    uint64_t tag = asyncReaderWait(&reader->reader);
+    int file = (int) (tag >> 32);
+    int block = (int) (uint32_t) tag;
+
+    prefetch->waiting[file]--;
+    prefetch->blockWaiting[block]--;
+
+    //a reader asks for all of one block's reads before the next, and all of one
+    //file's before taking the next, so either is finished once nothing is out
+    //and it isn't still being asked for
+    if (prefetch->blockWaiting[block] == 0 && block != reader->block){
+        fetchQueuePush(&prefetch->ready, block);
+    }//if
+
+    if (prefetch->waiting[file] == 0 && file != reader->file){
+        close(prefetch->fds[file]);
+        prefetch->fds[file] = -1;
+    }//if
+
+}//filePrefetchCollect
+
+/**
+ * @param prefetch: the prefetcher to set up
+ * @param files: the opened files
+ * @param total: how many
+ * @param array: where the numbers go
+ * @param blockStarts: block b goes at blockStarts[b], counted in numbers
+ * @param firstBlock: file i is blocks [firstBlock[i], firstBlock[i + 1]) (dataFilesBlocks)
+ * @param keySize: bytes per number of the key type
+ * @param keyType: DATA_I32 ... DATA_F64, the key type
+ * @param depth: reads each reader keeps in flight
+ * @param readers: how many reader threads
+ * @return void
+ */
+static inline void filePrefetchInit(file_prefetch* prefetch, data_file* files, int total, char* array,
+        const size_t* blockStarts, const int* firstBlock, size_t keySize, int keyType, int depth, int readers){
+
+    prefetch->files = files;
+    prefetch->total = total;
+    prefetch->array = array;
+    prefetch->blockStarts = blockStarts;
+    prefetch->firstBlock = firstBlock;
+    prefetch->keySize = keySize;
+    prefetch->keyType = keyType;
+    atomic_init(&prefetch->nextFile, 0);
+    prefetch->fds = malloc(sizeof(int) * total);
+    prefetch->waiting = calloc(total, sizeof(int));
+    prefetch->blockWaiting = calloc(firstBlock[total], sizeof(int));
+    prefetch->readerCount = (readers > 0) ? readers : 1;
+    prefetch->readers = malloc(sizeof(file_reader) * prefetch->readerCount);
+
+    if (prefetch->fds == NULL || prefetch->waiting == NULL || prefetch->blockWaiting == NULL
+            || prefetch->readers == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the prefetcher\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    for (int i = 0 ; i < total ; i++){
+        prefetch->fds[i] = -1;
+    }//for
+
+    fetchQueueInit(&prefetch->ready, ASYNC_READY_BLOCKS);
+
+    for (int r = 0 ; r < prefetch->readerCount ; r++){
+        asyncReaderInit(&prefetch->readers[r].reader, depth, true);
+        prefetch->readers[r].prefetch = prefetch;
+        prefetch->readers[r].file = -1;
+        prefetch->readers[r].block = -1;
+        prefetch->readers[r].nextByte = 0;
+    }//for
+
+}//filePrefetchInit
+
+/**
+ * @param prefetch: the prefetcher
+ * @return int: the next block that is in the array, in whatever order they come in.
+ *              Call it once for every block
+ */
+static inline int filePrefetchNext(file_prefetch* prefetch){
+    return fetchQueuePop(&prefetch->ready);
+}//filePrefetchNext
+
+/**
+ * Waits for the reader threads to finish and cleans up. Every block must have
+ * been taken with filePrefetchNext
+ *
+ * @param prefetch: the prefetcher
+ * @return void
+ */
+static inline void filePrefetchFinish(file_prefetch* prefetch){
+
+    for (int r = 0 ; r < prefetch->readerCount ; r++){
+        pthread_join(prefetch->readers[r].thread, NULL);
+        asyncReaderDestroy(&prefetch->readers[r].reader);
+    }//for
+
+    fetchQueueDestroy(&prefetch->ready);
+    free(prefetch->readers);
+    free(prefetch->fds);
+    free(prefetch->waiting);
+    free(prefetch->blockWaiting);
+
+}//filePrefetchFinish
+
+#define ASYNC_READ_DEFINE(T, S, TYPE) \
+\
+/* Pthread function: one reader, until no files are left and its reads are all in */ \
+static void* filePrefetchThread_##S(void* arg){ \
+    file_reader* reader = (file_reader *) arg; \
+    file_prefetch* prefetch = reader->prefetch; \
+    data_file* f; \
+    int file; \
+    size_t fileStart, first; \
+    while (true){ \
+        file = filePrefetchPump(reader); \
+        if (file >= 0){ \
+            /* converted (or copied out of the parsed text) on the spot a block at */ \
+            /* a time, while the reads already asked for go on */ \
+            f = &prefetch->files[file]; \
+            fileStart = prefetch->blockStarts[prefetch->firstBlock[file]]; \
+            for (int b = prefetch->firstBlock[file] ; b < prefetch->firstBlock[file + 1] ; b++){ \
+                first = prefetch->blockStarts[b] - fileStart; \
+                dataFileLoad_##S(f, first, (T *) prefetch->array + prefetch->blockStarts[b], \
+                    prefetch->blockStarts[b + 1] - prefetch->blockStarts[b]); \
+                dataFileRelease(f, prefetch->blockStarts[b + 1] - fileStart); \
+                fetchQueuePush(&prefetch->ready, b); \
+            } \
+        } \
+        else if (reader->reader.inFlight > 0){ \
+            filePrefetchCollect(reader); \
+        } \
+        else{ \
+            return NULL; \
+        } \
+    } \
+} \
+\
+static inline void filePrefetchStart_##S(file_prefetch* prefetch, data_file* files, int total, T* array, \
+        const size_t* blockStarts, const int* firstBlock, int depth, int readers){ \
+    filePrefetchInit(prefetch, files, total, (char *) array, blockStarts, firstBlock, sizeof(T), (TYPE), \
+        depth, readers); \
+    for (int r = 0 ; r < prefetch->readerCount ; r++){ \
+        pthread_create(&prefetch->readers[r].thread, NULL, filePrefetchThread_##S, &prefetch->readers[r]); \
+    } \
+}
+
+ASYNC_READ_DEFINE(int32_t, i32, DATA_I32)
+ASYNC_READ_DEFINE(int64_t, i64, DATA_I64)
+ASYNC_READ_DEFINE(uint32_t, u32, DATA_U32)
+ASYNC_READ_DEFINE(uint64_t, u64, DATA_U64)
+ASYNC_READ_DEFINE(float, f32, DATA_F32)
+ASYNC_READ_DEFINE(double, f64, DATA_F64)
+
+#endif
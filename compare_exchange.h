@@ -0,0 +1,326 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Odd-Even Transposition Sort
+ *
+ * compare_exchange.h
+ *
+ * Branchless compare-exchange kernels for one odd or even phase
+ *
+ * A phase compares every adjacent pair (base[0], base[1]), (base[2], base[3])...
+ * and puts the smaller value first. Instead of branching on array[i] > array[i+1]
+ * (which mispredicts constantly on random data), each vector is shuffled so every
+ * element sits next to its partner, and min/max are blended back so the even lanes
+ * get the min and the odd lanes get the max. Whether anything was swapped comes from
+ * the movemask of the greater-than compare
+ *
+ * There is one kernel per key type supported by sort_core.h, named with the type's
+ * suffix (i32, i64, u32, u64, f32, f64). SSE2, AVX2 and AVX-512 versions are picked
+ * at runtime based on what the cpu supports, with a plain (cmov) loop used for the
+ * leftover pairs, for instruction sets missing the needed compare, and on other cpus
+ *
+ * Methods:
+ *  - compareExchange_<type>(T* base, size_t pairs) -> bool
+ *      Compare-exchanges pairs adjacent pairs starting at base with the widest
+ *      kernel the cpu has. Returns true if any pair was out of order
+ *
+ *  - compareExchangeScalar_<type>(T* base, size_t pairs) -> bool
+ *      Portable version, also used for the pairs left over after the vector loop
+ *
+ *  - compareExchangeSse2_<type> / Avx2_<type> / Avx512_<type>(T* base, size_t pairs) -> bool
+ *      The kernels for each instruction set
+ */
+#ifndef COMPARE_EXCHANGE_H
+#define COMPARE_EXCHANGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CMPX_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Scalar compare-exchange of adjacent pairs. Written so the compiler
+ * uses conditional moves instead of a branch
+ *
+ * @param base: address of the first element of the first pair
+ * @param pairs: how many pairs to compare
+ * @return bool: true if any pair was out of order
+ */
+#define CMPX_SCALAR(T, S) \
+static inline bool compareExchangeScalar_##S(T* base, size_t pairs){ \
+    bool swapped = false; \
+    for (size_t k = 0 ; k < pairs ; k++){ \
+        T a = base[2 * k]; \
+        T b = base[2 * k + 1]; \
+        swapped |= a > b; \
+        base[2 * k] = (a < b) ? a : b; \
+        base[2 * k + 1] = (a < b) ? b : a; \
+    } \
+    return swapped; \
+}
+
+CMPX_SCALAR(int32_t, i32)
+CMPX_SCALAR(int64_t, i64)
+CMPX_SCALAR(uint32_t, u32)
+CMPX_SCALAR(uint64_t, u64)
+CMPX_SCALAR(float, f32)
+CMPX_SCALAR(double, f64)
+
+#ifdef CMPX_X86
+
+/*
+ * SSE2
+ *
+ * No pminsd or 64 bit compare in SSE2. 32 bit ints are selected with and/andnot on
+ * the compare mask (unsigned ones are compared with the sign bit flipped), 64 bit
+ * ints fall back to the scalar loop
+ */
+
+//keeps the even lanes of mn and the odd lanes of mx
+#define CMPX_SSE2_BLEND(mn, mx, evenLanes) \
+    _mm_or_si128(_mm_and_si128(evenLanes, mn), _mm_andnot_si128(evenLanes, mx))
+
+#define CMPX_SSE2_INT32(T, S, BIAS) \
+__attribute__((target("sse2"))) \
+static inline bool compareExchangeSse2_##S(T* base, size_t pairs){ \
+    const __m128i evenLanes = _mm_set_epi32(0, -1, 0, -1); \
+    const __m128i bias = _mm_set1_epi32(BIAS); \
+    int mask = 0; \
+    size_t k = 0; \
+    for ( ; k + 2 <= pairs ; k += 2){ \
+        __m128i v = _mm_loadu_si128((__m128i *) &base[2 * k]); \
+        __m128i s = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)); \
+        __m128i gt = _mm_cmpgt_epi32(_mm_xor_si128(v, bias), _mm_xor_si128(s, bias)); \
+        __m128i mn = _mm_or_si128(_mm_and_si128(gt, s), _mm_andnot_si128(gt, v)); \
+        __m128i mx = _mm_or_si128(_mm_and_si128(gt, v), _mm_andnot_si128(gt, s)); \
+        mask |= _mm_movemask_ps(_mm_castsi128_ps(gt)); \
+        _mm_storeu_si128((__m128i *) &base[2 * k], CMPX_SSE2_BLEND(mn, mx, evenLanes)); \
+    } \
+    return (mask & 0x5) | compareExchangeScalar_##S(&base[2 * k], pairs - k); \
+}
+
+CMPX_SSE2_INT32(int32_t, i32, 0)
+CMPX_SSE2_INT32(uint32_t, u32, INT32_MIN)
+
+__attribute__((target("sse2")))
+static inline bool compareExchangeSse2_f32(float* base, size_t pairs){
+
+    const __m128i evenLanes = _mm_set_epi32(0, -1, 0, -1);
+    int mask = 0;
+    size_t k = 0;
+
+    for ( ; k + 2 <= pairs ; k += 2){
+
+        __m128 v = _mm_loadu_ps(&base[2 * k]);
+        __m128 s = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128i mn = _mm_castps_si128(_mm_min_ps(v, s));
+        __m128i mx = _mm_castps_si128(_mm_max_ps(v, s));
+
+        mask |= _mm_movemask_ps(_mm_cmpgt_ps(v, s));
+        _mm_storeu_ps(&base[2 * k], _mm_castsi128_ps(CMPX_SSE2_BLEND(mn, mx, evenLanes)));
+
+    }//for
+
+    return (mask & 0x5) | compareExchangeScalar_f32(&base[2 * k], pairs - k);
+
+}//compareExchangeSse2_f32
+
+__attribute__((target("sse2")))
+static inline bool compareExchangeSse2_f64(double* base, size_t pairs){
+
+    int mask = 0;
+
+    for (size_t k = 0 ; k < pairs ; k++){
+
+        __m128d v = _mm_loadu_pd(&base[2 * k]);
+        __m128d s = _mm_shuffle_pd(v, v, 1);
+
+        mask |= _mm_movemask_pd(_mm_cmpgt_pd(v, s));
+        //low lane from the min, high lane from the max
+        _mm_storeu_pd(&base[2 * k], _mm_move_sd(_mm_max_pd(v, s), _mm_min_pd(v, s)));
+
+    }//for
+
+    return mask & 0x1;
+
+}//compareExchangeSse2_f64
+
+/*
+ * AVX2
+ *
+ * 4 pairs of 32 bit keys or 2 pairs of 64 bit keys per vector. There is no
+ * 64 bit min/max, so those are blended with the compare mask
+ */
+
+#define CMPX_AVX2_INT32(T, S, MIN, MAX, BIAS) \
+__attribute__((target("avx2"))) \
+static inline bool compareExchangeAvx2_##S(T* base, size_t pairs){ \
+    const __m256i bias = _mm256_set1_epi32(BIAS); \
+    int mask = 0; \
+    size_t k = 0; \
+    for ( ; k + 4 <= pairs ; k += 4){ \
+        __m256i v = _mm256_loadu_si256((__m256i *) &base[2 * k]); \
+        __m256i s = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)); \
+        __m256i gt = _mm256_cmpgt_epi32(_mm256_xor_si256(v, bias), _mm256_xor_si256(s, bias)); \
+        mask |= _mm256_movemask_ps(_mm256_castsi256_ps(gt)); \
+        _mm256_storeu_si256((__m256i *) &base[2 * k], \
+            _mm256_blend_epi32(MIN(v, s), MAX(v, s), 0xAA)); \
+    } \
+    return (mask & 0x55) | compareExchangeScalar_##S(&base[2 * k], pairs - k); \
+}
+
+CMPX_AVX2_INT32(int32_t, i32, _mm256_min_epi32, _mm256_max_epi32, 0)
+CMPX_AVX2_INT32(uint32_t, u32, _mm256_min_epu32, _mm256_max_epu32, INT32_MIN)
+
+#define CMPX_AVX2_INT64(T, S, BIAS) \
+__attribute__((target("avx2"))) \
+static inline bool compareExchangeAvx2_##S(T* base, size_t pairs){ \
+    const __m256i bias = _mm256_set1_epi64x(BIAS); \
+    int mask = 0; \
+    size_t k = 0; \
+    for ( ; k + 2 <= pairs ; k += 2){ \
+        __m256i v = _mm256_loadu_si256((__m256i *) &base[2 * k]); \
+        __m256i s = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 3, 0, 1)); \
+        __m256i gt = _mm256_cmpgt_epi64(_mm256_xor_si256(v, bias), _mm256_xor_si256(s, bias)); \
+        __m256i mn = _mm256_blendv_epi8(v, s, gt); \
+        __m256i mx = _mm256_blendv_epi8(s, v, gt); \
+        mask |= _mm256_movemask_pd(_mm256_castsi256_pd(gt)); \
+        _mm256_storeu_si256((__m256i *) &base[2 * k], _mm256_blend_epi32(mn, mx, 0xCC)); \
+    } \
+    return (mask & 0x5) | compareExchangeScalar_##S(&base[2 * k], pairs - k); \
+}
+
+CMPX_AVX2_INT64(int64_t, i64, 0)
+CMPX_AVX2_INT64(uint64_t, u64, INT64_MIN)
+
+__attribute__((target("avx2")))
+static inline bool compareExchangeAvx2_f32(float* base, size_t pairs){
+
+    int mask = 0;
+    size_t k = 0;
+
+    for ( ; k + 4 <= pairs ; k += 4){
+
+        __m256 v = _mm256_loadu_ps(&base[2 * k]);
+        __m256 s = _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1));
+
+        mask |= _mm256_movemask_ps(_mm256_cmp_ps(v, s, _CMP_GT_OQ));
+        _mm256_storeu_ps(&base[2 * k],
+            _mm256_blend_ps(_mm256_min_ps(v, s), _mm256_max_ps(v, s), 0xAA));
+
+    }//for
+
+    return (mask & 0x55) | compareExchangeScalar_f32(&base[2 * k], pairs - k);
+
+}//compareExchangeAvx2_f32
+
+__attribute__((target("avx2")))
+static inline bool compareExchangeAvx2_f64(double* base, size_t pairs){
+
+    int mask = 0;
+    size_t k = 0;
+
+    for ( ; k + 2 <= pairs ; k += 2){
+
+        __m256d v = _mm256_loadu_pd(&base[2 * k]);
+        __m256d s = _mm256_permute_pd(v, 0x5);
+
+        mask |= _mm256_movemask_pd(_mm256_cmp_pd(v, s, _CMP_GT_OQ));
+        _mm256_storeu_pd(&base[2 * k],
+            _mm256_blend_pd(_mm256_min_pd(v, s), _mm256_max_pd(v, s), 0xA));
+
+    }//for
+
+    return (mask & 0x5) | compareExchangeScalar_f64(&base[2 * k], pairs - k);
+
+}//compareExchangeAvx2_f64
+
+/*
+ * AVX-512
+ *
+ * 8 pairs of 32 bit keys or 4 pairs of 64 bit keys per vector. The compare
+ * gives a mask register directly, and every type has its own min/max
+ */
+
+#define CMPX_AVX512(T, S, VEC, LOAD, STORE, SHUF, CMPGT, MIN, MAX, BLEND, MASK_T, ODD, EVEN) \
+__attribute__((target("avx512f"))) \
+static inline bool compareExchangeAvx512_##S(T* base, size_t pairs){ \
+    const size_t step = 32 / sizeof(T); \
+    MASK_T mask = 0; \
+    size_t k = 0; \
+    for ( ; k + step <= pairs ; k += step){ \
+        VEC v = LOAD((void *) &base[2 * k]); \
+        VEC s = SHUF; \
+        mask |= CMPGT; \
+        STORE((void *) &base[2 * k], BLEND(ODD, MIN(v, s), MAX(v, s))); \
+    } \
+    return (mask & EVEN) | compareExchangeScalar_##S(&base[2 * k], pairs - k); \
+}
+
+CMPX_AVX512(int32_t, i32, __m512i, _mm512_loadu_si512, _mm512_storeu_si512,
+    _mm512_shuffle_epi32(v, _MM_PERM_CDAB), _mm512_cmpgt_epi32_mask(v, s),
+    _mm512_min_epi32, _mm512_max_epi32, _mm512_mask_blend_epi32, __mmask16, 0xAAAA, 0x5555)
+
+CMPX_AVX512(uint32_t, u32, __m512i, _mm512_loadu_si512, _mm512_storeu_si512,
+    _mm512_shuffle_epi32(v, _MM_PERM_CDAB), _mm512_cmpgt_epu32_mask(v, s),
+    _mm512_min_epu32, _mm512_max_epu32, _mm512_mask_blend_epi32, __mmask16, 0xAAAA, 0x5555)
+
+CMPX_AVX512(int64_t, i64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512,
+    _mm512_shuffle_epi32(v, _MM_PERM_BADC), _mm512_cmpgt_epi64_mask(v, s),
+    _mm512_min_epi64, _mm512_max_epi64, _mm512_mask_blend_epi64, __mmask8, 0xAA, 0x55)
+
+CMPX_AVX512(uint64_t, u64, __m512i, _mm512_loadu_si512, _mm512_storeu_si512,
+    _mm512_shuffle_epi32(v, _MM_PERM_BADC), _mm512_cmpgt_epu64_mask(v, s),
+    _mm512_min_epu64, _mm512_max_epu64, _mm512_mask_blend_epi64, __mmask8, 0xAA, 0x55)
+
+CMPX_AVX512(float, f32, __m512, _mm512_loadu_ps, _mm512_storeu_ps,
+    _mm512_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)), _mm512_cmp_ps_mask(v, s, _CMP_GT_OQ),
+    _mm512_min_ps, _mm512_max_ps, _mm512_mask_blend_ps, __mmask16, 0xAAAA, 0x5555)
+
+CMPX_AVX512(double, f64, __m512d, _mm512_loadu_pd, _mm512_storeu_pd,
+    _mm512_permute_pd(v, 0x55), _mm512_cmp_pd_mask(v, s, _CMP_GT_OQ),
+    _mm512_min_pd, _mm512_max_pd, _mm512_mask_blend_pd, __mmask8, 0xAA, 0x55)
+
+//64 bit ints have no SSE2 kernel
+#define compareExchangeSse2_i64 compareExchangeScalar_i64
+#define compareExchangeSse2_u64 compareExchangeScalar_u64
+
+#endif
+
+/**
+ * Compare-exchanges adjacent pairs with the widest kernel the cpu has
+ *
+ * @param base: address of the first element of the first pair
+ * @param pairs: how many pairs to compare
+ * @return bool: true if any pair was out of order
+ */
+#ifdef CMPX_X86
+#define CMPX_DISPATCH(T, S) \
+static inline bool compareExchange_##S(T* base, size_t pairs){ \
+    if (__builtin_cpu_supports("avx512f")){ \
+        return compareExchangeAvx512_##S(base, pairs); \
+    } \
+    if (__builtin_cpu_supports("avx2")){ \
+        return compareExchangeAvx2_##S(base, pairs); \
+    } \
+    return compareExchangeSse2_##S(base, pairs); \
+}
+#else
+#define CMPX_DISPATCH(T, S) \
+static inline bool compareExchange_##S(T* base, size_t pairs){ \
+    return compareExchangeScalar_##S(base, pairs); \
+}
+#endif
+
+CMPX_DISPATCH(int32_t, i32)
+CMPX_DISPATCH(int64_t, i64)
+CMPX_DISPATCH(uint32_t, u32)
+CMPX_DISPATCH(uint64_t, u64)
+CMPX_DISPATCH(float, f32)
+CMPX_DISPATCH(double, f64)
+
+#endif
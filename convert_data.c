@@ -0,0 +1,137 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Data Files
+ *
+ * convert_data.c
+ *
+ * Turns the old text data files (numbers written with "%lf ") into the binary
+ * format of data_files.h, so the task programs can map them instead of parsing them
+ *
+ * With no arguments, data1.txt ... data8.txt are converted to data1.bin ... data8.bin
+ * (files that don't exist are skipped). Given an input and output name, just that
+ * one file is converted. The numbers are stored as doubles, like in the text files.
+ * Big text files are parsed with one thread per processor
+ *
+ * Methods:
+ *  - main(int argc, const char* argv[]) -> int
+ *      Converts the default files or the one given
+ *
+ *  - convertFile(const char* in, const char* out, worker_pool* parsers) -> bool
+ *      Converts one file, false if in can't be opened
+ *
+ *  - Usage(const char* prog_name) -> void
+ *      Prints to stderr how to use the program
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "data_files.h"
+
+#define TOTAL_FILES 8 //files converted when none are named
+
+//Function Prototypes
+bool convertFile(const char* in, const char* out, worker_pool* parsers);
+void Usage(const char* prog_name);
+
+/**
+ * Converts data1.txt ... data8.txt, or the file named on the command line
+ *
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given
+ * @return int
+ */
+int main(int argc, const char* argv[]){
+
+    char in[32], out[32];
+    worker_pool parsers;
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    poolInit(&parsers, (processors > 1) ? (int) processors : 1);
+
+    switch (argc){
+
+        case 1:
+
+            for (int i = 0 ; i < TOTAL_FILES ; i++){
+
+                sprintf(in, "data%d.txt", i + 1);
+                sprintf(out, "data%d.bin", i + 1);
+
+                if (convertFile(in, out, &parsers)){
+                    printf("%s -> %s\n", in, out);
+                }//if
+
+            }//for
+
+            break;
+
+        case 3:
+
+            if (!convertFile(argv[1], argv[2], &parsers)){
+                perror(argv[1]);
+                return EXIT_FAILURE;
+            }//if
+
+            break;
+
+        default:
+            Usage(argv[0]);
+            return EXIT_SUCCESS;
+
+    }//switch
+
+    poolDestroy(&parsers);
+
+    return EXIT_SUCCESS;
+
+}//main
+
+/**
+ * Reads every number in a data file (text, or binary of any type) and
+ * writes them to a binary file of doubles
+ *
+ * @param in: file to convert
+ * @param out: binary file to write
+ * @param parsers: threads to parse a big text file with
+ * @return bool: false if in couldn't be opened
+ */
+bool convertFile(const char* in, const char* out, worker_pool* parsers){
+
+    data_file file;
+    double* values;
+
+    if (!dataFileOpenPool(&file, in, parsers)){
+        return false;
+    }//if
+
+    values = malloc(sizeof(double) * (file.count + 1));
+
+    if (values == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", file.count);
+        exit(EXIT_FAILURE);
+    }//if
+
+    dataFileLoad_f64(&file, 0, values, file.count);
+    dataFileWrite(out, DATA_F64, values, file.count);
+
+    free(values);
+    dataFileClose(&file);
+
+    return true;
+
+}//convertFile
+
+/**
+ * Displays how to use the program.
+ *
+ * @param prog_name: name of the program
+ * @return void
+ */
+void Usage(const char* prog_name){
+   fprintf(stderr, "usage:   %s <in> <out>\n", prog_name);
+   fprintf(stderr, "  with no arguments, converts data1.txt ... data%d.txt to .bin files\n", TOTAL_FILES);
+   fprintf(stderr, "   in:   text data file to convert\n");
+   fprintf(stderr, "  out:   binary data file to write\n");
+}//Usage
@@ -0,0 +1,231 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Counting Sort
+ *
+ * counting_sort.h
+ *
+ * Parallel counting sort for integer keys in a small known range, run on worker_pool.h
+ *
+ * When every key is in [lo, hi] and hi - lo is small next to the number of keys,
+ * there's no need to move keys around at all: count how many times each value
+ * shows up and write the values back out in order that many times.
+ *
+ * Every thread counts its own chunk of the array into its own table, so nobody
+ * shares a counter. The tables are then added up, each thread summing its own
+ * slice of the key range, and turned into the position where each value starts.
+ * Finally every thread writes its own chunk of the output: it looks up which
+ * value its first position belongs to and fills in runs of values from there.
+ * The sort is done in place, no second array needed.
+ *
+ * The range can be given (when the program knows how its keys were made) or
+ * found with keyRange, which is a parallel min/max
+ *
+ * Methods (one of each per type, T is the key type):
+ *  - keyRange_<type>(worker_pool* pool, const T* array, size_t n, T* lo, T* hi) -> void
+ *      Finds the smallest and largest key with every thread of the pool
+ *
+ *  - countingSort_<type>(worker_pool* pool, T* array, size_t n, T lo, T hi) -> bool
+ *      Sorts array, whose keys are all in [lo, hi], with every thread of the pool.
+ *      Returns false without sorting if the range is over COUNTING_MAX_RANGE values,
+ *      or over the number of keys each thread counts: past that the count tables
+ *      are bigger than the array and adding them up costs more than the sort
+ *
+ *  - rangeJob_<type>(int rank, void* arg) -> void
+ *      Pool job, min and max of one chunk
+ *
+ *  - countingJob_<type>(int rank, void* arg) -> void
+ *      Pool job, what every thread runs for one sort
+ */
+#ifndef COUNTING_SORT_H
+#define COUNTING_SORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "worker_pool.h"
+#include "spin_barrier.h"
+
+#define COUNTING_MAX_RANGE (1 << 24) //most distinct values a count table is made for
+
+//which key types counting sort can handle, for checking SORT_KEY with #if
+#define COUNTING_KEY_i32 1
+#define COUNTING_KEY_i64 1
+#define COUNTING_KEY_u32 1
+#define COUNTING_KEY_u64 1
+
+#define COUNTING_DEFINE(T, U, S) \
+\
+/* shared by every thread of one min/max search */ \
+typedef struct { \
+    const T* array; \
+    size_t n; \
+    int thread_count; \
+    T* mins; \
+    T* maxs; \
+} key_range_data_##S; \
+\
+/* shared by every thread of one sort */ \
+typedef struct { \
+    T* array; \
+    size_t n; \
+    T lo; \
+    size_t range; \
+    int thread_count; \
+    size_t* counts; /* [thread][value], turned into starts[value] */ \
+    size_t* starts; /* where each value starts in the output, starts[range] == n */ \
+    size_t* sliceSums; /* keys in each thread's slice of the range */ \
+    spin_barrier barrier; \
+} counting_sort_data_##S; \
+\
+static void rangeJob_##S(int rank, void* arg){ \
+    key_range_data_##S* data = (key_range_data_##S *) arg; \
+    size_t myStart = chunkStart(rank, data->thread_count, data->n); \
+    size_t myEnd = chunkStart(rank + 1, data->thread_count, data->n); \
+    T lo, hi; \
+    if (myStart == myEnd){ \
+        data->mins[rank] = data->array[0]; \
+        data->maxs[rank] = data->array[0]; \
+        return; \
+    } \
+    lo = hi = data->array[myStart]; \
+    for (size_t i = myStart + 1 ; i < myEnd ; i++){ \
+        lo = (data->array[i] < lo) ? data->array[i] : lo; \
+        hi = (data->array[i] > hi) ? data->array[i] : hi; \
+    } \
+    data->mins[rank] = lo; \
+    data->maxs[rank] = hi; \
+} \
+\
+static inline void keyRange_##S(worker_pool* pool, const T* array, size_t n, T* lo, T* hi){ \
+    key_range_data_##S data; \
+    if (n == 0){ \
+        *lo = *hi = 0; \
+        return; \
+    } \
+    data.array = array; \
+    data.n = n; \
+    data.thread_count = pool->thread_count; \
+    data.mins = malloc(sizeof(T) * pool->thread_count); \
+    data.maxs = malloc(sizeof(T) * pool->thread_count); \
+    if (data.mins == NULL || data.maxs == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the key range\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    poolRun(pool, rangeJob_##S, &data); \
+    *lo = data.mins[0]; \
+    *hi = data.maxs[0]; \
+    for (int t = 1 ; t < pool->thread_count ; t++){ \
+        *lo = (data.mins[t] < *lo) ? data.mins[t] : *lo; \
+        *hi = (data.maxs[t] > *hi) ? data.maxs[t] : *hi; \
+    } \
+    free(data.mins); \
+    free(data.maxs); \
+} \
+\
+static void countingJob_##S(int rank, void* arg){ \
+    counting_sort_data_##S* data = (counting_sort_data_##S *) arg; \
+    int p = data->thread_count; \
+    size_t range = data->range; \
+    size_t myStart = chunkStart(rank, p, data->n); \
+    size_t myEnd = chunkStart(rank + 1, p, data->n); \
+    size_t keyStart = chunkStart(rank, p, range); \
+    size_t keyEnd = chunkStart(rank + 1, p, range); \
+    size_t* mine = &data->counts[(size_t) rank * range]; \
+    size_t sum = 0, total, pos, low, high, mid; \
+    T* array = data->array; \
+    /* count my chunk into my own table */ \
+    memset(mine, 0, sizeof(size_t) * range); \
+    for (size_t i = myStart ; i < myEnd ; i++){ \
+        mine[(U) array[i] - (U) data->lo]++; \
+    } \
+    spinBarrierWait(&data->barrier, rank); \
+    /* add up the tables for my slice of the values */ \
+    for (size_t k = keyStart ; k < keyEnd ; k++){ \
+        total = 0; \
+        for (int t = 0 ; t < p ; t++){ \
+            total += data->counts[(size_t) t * range + k]; \
+        } \
+        data->starts[k] = total; \
+        sum += total; \
+    } \
+    data->sliceSums[rank] = sum; \
+    spinBarrierWait(&data->barrier, rank); \
+    /* counts -> starting positions, offset by the slices below mine */ \
+    pos = 0; \
+    for (int t = 0 ; t < rank ; t++){ \
+        pos += data->sliceSums[t]; \
+    } \
+    for (size_t k = keyStart ; k < keyEnd ; k++){ \
+        total = data->starts[k]; \
+        data->starts[k] = pos; \
+        pos += total; \
+    } \
+    if (rank == p - 1){ \
+        data->starts[range] = data->n; \
+    } \
+    spinBarrierWait(&data->barrier, rank); \
+    if (myStart == myEnd){ \
+        return; \
+    } \
+    /* last value starting at or before my first position */ \
+    low = 0; \
+    high = range - 1; \
+    while (low < high){ \
+        mid = low + (high - low + 1) / 2; \
+        if (data->starts[mid] <= myStart){ \
+            low = mid; \
+        } \
+        else{ \
+            high = mid - 1; \
+        } \
+    } \
+    /* fill in my part of the output, one run of equal values at a time */ \
+    pos = myStart; \
+    for (size_t k = low ; pos < myEnd ; k++){ \
+        size_t runEnd = (data->starts[k + 1] < myEnd) ? data->starts[k + 1] : myEnd; \
+        T value = (T) ((U) data->lo + (U) k); \
+        while (pos < runEnd){ \
+            array[pos++] = value; \
+        } \
+    } \
+} \
+\
+static inline bool countingSort_##S(worker_pool* pool, T* array, size_t n, T lo, T hi){ \
+    counting_sort_data_##S data; \
+    U span = (U) hi - (U) lo; \
+    if (n < 2){ \
+        return true; \
+    } \
+    if (hi < lo || span >= COUNTING_MAX_RANGE || (size_t) span >= n / pool->thread_count){ \
+        return false; \
+    } \
+    data.array = array; \
+    data.n = n; \
+    data.lo = lo; \
+    data.range = (size_t) span + 1; \
+    data.thread_count = pool->thread_count; \
+    data.counts = malloc(sizeof(size_t) * data.range * pool->thread_count); \
+    data.starts = malloc(sizeof(size_t) * (data.range + 1)); \
+    data.sliceSums = malloc(sizeof(size_t) * pool->thread_count); \
+    if (data.counts == NULL || data.starts == NULL || data.sliceSums == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the count tables\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    spinBarrierInit(&data.barrier, pool->thread_count); \
+    poolRun(pool, countingJob_##S, &data); \
+    spinBarrierDestroy(&data.barrier); \
+    free(data.counts); \
+    free(data.starts); \
+    free(data.sliceSums); \
+    return true; \
+}
+
+COUNTING_DEFINE(int32_t, uint32_t, i32)
+COUNTING_DEFINE(int64_t, uint64_t, i64)
+COUNTING_DEFINE(uint32_t, uint32_t, u32)
+COUNTING_DEFINE(uint64_t, uint64_t, u64)
+
+#endif
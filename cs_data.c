@@ -0,0 +1,218 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Counting Sort
+ *
+ * cs_data.c
+ *
+ * Serial and parallel implementation of counting sort used for comparsion of
+ * parallel odd-even transposition sort, quicksort and radix sort with data
+ * level parallelism
+ *
+ * Generates an array of ints into memory based on arguments from the command line.
+ * The range of the keys is found (keyRange), and then counting sort
+ * (counting_sort.h) is used to serially or parallelly sort the array. The
+ * generated numbers are all between 0 and MAX, so the count tables are tiny and
+ * the sort is just two reads and one write of the array. If the keys turn out
+ * to be spread over more than COUNTING_MAX_RANGE values, or over more values than
+ * each thread has keys to count, radix sort is used instead
+ *
+ * Counting sort only works on integer keys. The key type comes from sort_core.h and
+ * defaults to 32 bit ints. Compile with -DSORT_KEY=i64, u32 or u64 to sort a
+ * different type
+ *
+ * Takes the same arguments as oets_data.c and qs_data.c. The serial sort is the
+ * same code run by a single thread
+ *
+ * The time to sort is recorded and printed to stdout
+ *
+ * Methods:
+ *  - main(int argc, const char* argv[]) -> int
+ *      Creates a globally avaliable array and executes the sort serially
+ *      or paralelly based on args
+ *
+ *  - keyRange and countingSort come from counting_sort.h, radixSort from radix_sort.h
+ *
+ *  - Usage(const char* prog_name) -> void
+ *      Prints to stderr how to use the program
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef SORT_KEY
+#define SORT_KEY i32
+#endif
+#include "sort_core.h"
+#include "worker_pool.h"
+#include "random_fill.h"
+#include "radix_sort.h"
+#include "counting_sort.h"
+
+#if !SORT_XPASTE(COUNTING_KEY_, SORT_KEY)
+#error "counting sort only sorts integer keys, use SORT_KEY=i32, i64, u32 or u64"
+#endif
+
+//set the upper bound for numbers generated
+#define MAX 1000
+
+//global variables
+elem_t* array;
+elem_t* scratch;
+double elapsed = 0;
+int thread_count;
+worker_pool pool;
+
+//Function Prototypes
+void Usage(const char* prog_name);
+
+/**
+ * Preps the call to counting sort by checking the arguments for serial
+ * or parallel execution. Then randomly generates an array of the provided
+ * size (if not provided, size 8 is default). Parallel sorts use 2 threads
+ * unless told otherwise
+ *
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given
+ * @return int
+ */
+int main(int argc, const char* argv[]){
+
+    size_t arraySize;
+    bool parallel = true;
+    bool counted;
+    elem_t lo, hi;
+    uint64_t seed;
+    struct timespec stop, start;
+
+    //--seed can go anywhere, the rest are checked by position
+    argc = randomSeedOption(argc, argv, &seed);
+
+    //check arguments
+    switch (argc){
+
+        case 1:
+            arraySize = 8;
+            thread_count = 2;
+            break;
+
+        case 2:
+
+            if (strcmp(argv[1], "-s") == 0){
+                parallel = false;
+                arraySize = 8;
+                thread_count = 1;
+            }//if
+
+            else{
+                //get size of array from command line
+                arraySize = strtoull(argv[1], NULL, 10);
+                thread_count = 2;
+            }//else
+
+            break;
+
+        case 3:
+
+            if (strcmp(argv[1], "-s") == 0){
+                parallel = false;
+                arraySize = strtoull(argv[2], NULL, 10);
+                thread_count = 1;
+            }//if
+
+            else{
+                //get size of array from command line
+                arraySize = strtoull(argv[1], NULL, 10);
+                thread_count = strtol(argv[2], NULL, 10);
+            }//else
+
+            break;
+
+        default:
+            Usage(argv[0]);
+            return EXIT_SUCCESS;
+
+    }//switch
+
+    if (thread_count < 1){
+        Usage(argv[0]);
+        return EXIT_SUCCESS;
+    }//if
+
+    array = malloc(sizeof(elem_t) * arraySize);
+
+    if (array == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", arraySize);
+        return EXIT_FAILURE;
+    }//if
+
+    //threads are created before timing starts, like oets_data.c
+    poolInit(&pool, thread_count);
+
+    //fill the array with random numbers between 0 and MAX, the same ones for the same seed
+    SORT(randomFill)(&pool, array, arraySize, MAX, seed);
+    printf("Seed %llu\n", (unsigned long long) seed);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    SORT(keyRange)(&pool, array, arraySize, &lo, &hi);
+    counted = SORT(countingSort)(&pool, array, arraySize, lo, hi);
+
+    //too many different keys for a count table
+    if (!counted){
+
+        scratch = malloc(sizeof(elem_t) * arraySize);
+
+        if (scratch == NULL){
+            fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", arraySize);
+            return EXIT_FAILURE;
+        }//if
+
+        SORT(radixSort)(&pool, array, scratch, arraySize);
+        free(scratch);
+
+    }//if
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    poolDestroy(&pool);
+
+    elapsed = (stop.tv_sec - start.tv_sec);
+    elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    if (parallel){
+        printf("\nParallel time on array of size %zu (%d threads):\n"
+            "%f seconds\n", arraySize, thread_count, elapsed);
+    }//if
+
+    else{
+        printf("\nSerial time on array of size %zu:\n"
+            "%f seconds\n", arraySize, elapsed);
+    }//else
+
+    if (!counted){
+        printf("(keys were too spread out for counting sort, radix sort was used)\n");
+    }//if
+
+    free(array);
+
+    return EXIT_SUCCESS;
+
+}//main
+
+/**
+ * Displays how to use the program.
+ *
+ * @param prog_name: name of the program
+ * @return void
+ */
+void Usage(const char* prog_name){
+   fprintf(stderr, "usage:   %s <-s> <n> <t> <--seed x>\n", prog_name);
+   fprintf(stderr, "  's':  run serial counting sort\n");
+   fprintf(stderr, "   n:   number of elements in list\n");
+   fprintf(stderr, "   t:   number of threads to use\n");
+   fprintf(stderr, "   x:   seed for the random numbers, the same seed sorts the same array\n");
+}//Usage
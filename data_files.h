@@ -0,0 +1,741 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Data Files
+ *
+ * data_files.h
+ *
+ * Binary data files for the task programs (oets_task.c and qs_task.c), read with mmap
+ *
+ * A binary file is a 32 byte header followed by the numbers themselves, exactly as
+ * they sit in memory:
+ *      magic       8 bytes, "SORTDATA"
+ *      byteOrder   uint32_t 0x01020304, as written by the machine that made the file
+ *      type        uint32_t, one of DATA_I32 ... DATA_F64
+ *      count       uint64_t, how many numbers follow
+ *      reserved    uint64_t, 0 (keeps the numbers 32 byte aligned)
+ *
+ * Opening a file maps it into memory instead of reading it, so loading numbers into
+ * the array to sort is a straight copy out of the page cache (or a cast, when the
+ * file holds a different type than the program sorts), with no parsing at all. Files
+ * written on a machine with the other byte order are detected by byteOrder and
+ * swapped while loading.
+ *
+ * Files without the magic are taken to be the old text files of "%lf " numbers
+ * and are parsed into memory as doubles, so existing data*.txt files still work.
+ * convert_data.c turns them into binary files once so they never have to be parsed again.
+ * A sort that only holds part of the numbers at a time (external_sort.h) opens them
+ * without parsing them instead, and reads them in a piece at a time itself
+ *
+ * Methods:
+ *  - dataFileOpen(data_file* file, const char* filename) -> bool
+ *      Maps a binary file (or parses a text file), false if it can't be opened
+ *
+ *  - dataFileOpenPool(data_file* file, const char* filename, worker_pool* parsers) -> bool
+ *      The same, parsing a big text file with the pool's threads (NULL for just this one)
+ *
+ *  - dataFileOpenLazy(data_file* file, const char* filename) -> bool
+ *      The same, but a text file is only checked and named (text is true), not parsed
+ *
+ *  - dataFileOpenWith(data_file* file, const char* filename, worker_pool* parsers, bool parse) -> bool
+ *      What all three do
+ *
+ *  - dataFileClose(data_file* file) -> void
+ *      Unmaps or frees the numbers
+ *
+ *  - dataFileRelease(data_file* file, size_t end) -> void
+ *      Drops the mapped pages holding numbers before end, once they've been used
+ *
+ *  - dataFileWrite(const char* filename, int type, const void* values, size_t count) -> void
+ *      Writes numbers of the given type to a binary file
+ *
+ *  - dataFileParseText(data_file* file, int fd, worker_pool* parsers) -> void
+ *      Reads a text file of numbers into memory as doubles (text_io.h), split
+ *      among the parsers if it is at least TEXT_SPLIT_MIN bytes
+ *
+ *  - dataFilesOpen(data_file* files, int total, size_t numsPerFile, double max,
+ *                  uint64_t seed, int threads, bool parse) -> void
+ *      Opens data1 ... data<total>, making binary files of random doubles below max
+ *      for any that don't exist (random_fill.h, file i is stream i of seed). Text
+ *      files are left unparsed unless parse is true
+ *
+ *  - dataFilesList(int count, const char* paths[], char*** names) -> int
+ *      Turns file and directory names into a list of files (a directory gives
+ *      every file in it, in name order, and "-" is standard input), returns how
+ *      many there are
+ *
+ *  - dataFilesOpenNamed(data_file* files, int total, char* names[], int threads, bool parse) -> void
+ *      Opens every file in a list, exits if one can't be opened. Big text files
+ *      are parsed with threads threads (or left unparsed unless parse is true)
+ *
+ *  - dataFilesStarts(const data_file* files, int total, size_t* starts) -> size_t
+ *      Where each file's numbers start when they are all put in one array,
+ *      returns the total (also in starts[total])
+ *
+ *  - dataFilesBlocks(const data_file* files, int total, size_t blockSize, int* firstBlock,
+ *                    size_t** blockStarts) -> int
+ *      The same array cut into blocks of blockSize numbers that never cross from
+ *      one file to the next, returns how many blocks there are
+ *
+ *  - dataFileLoad_<type>(const data_file* file, size_t first, T* out, size_t count) -> void
+ *      Copies count numbers starting at first into out, converting them to T
+ */
+#ifndef DATA_FILES_H
+#define DATA_FILES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "text_io.h"
+#include "random_fill.h"
+
+#define DATA_MAGIC "SORTDATA"
+#define DATA_BYTE_ORDER 0x01020304u
+#define DATA_STDIN "-" //the name that means standard input
+
+//what the numbers in a file are, in the order of the sort_core.h suffixes
+#define DATA_I32 1
+#define DATA_I64 2
+#define DATA_U32 3
+#define DATA_U64 4
+#define DATA_F32 5
+#define DATA_F64 6
+
+typedef struct {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t type;
+    uint64_t count;
+    uint64_t reserved;
+} data_header;
+
+typedef struct {
+    char* name; //so the file can be read again, not only through the map
+    void* map; //the whole mapped file, NULL for parsed text
+    size_t mapLength;
+    const void* values; //first number
+    size_t count;
+    int type;
+    bool swapped; //written with the other byte order
+    bool text; //a text file not parsed yet: no values and a count of 0 until it's read from name
+} data_file;
+
+/**
+ * @param type: DATA_I32 ... DATA_F64
+ * @return size_t: bytes per number of that type
+ */
+static inline size_t dataTypeSize(int type){
+    return (type == DATA_I64 || type == DATA_U64 || type == DATA_F64) ? 8 : 4;
+}//dataTypeSize
+
+/**
+ * Reads a text file of whitespace separated numbers into memory as doubles,
+ * with the block parser from text_io.h. A big one is mapped and parsed by
+ * every thread of parsers at once instead
+ *
+ * @param file: filled in with the numbers
+ * @param fd: the text file, at its beginning
+ * @param parsers: threads to parse a big file with, or NULL
+ * @return void
+ */
+static inline void dataFileParseText(data_file* file, int fd, worker_pool* parsers){
+
+    double* values;
+    struct stat info;
+
+    if (parsers != NULL && parsers->thread_count > 1 && fstat(fd, &info) == 0
+            && (size_t) info.st_size >= TEXT_SPLIT_MIN){
+        file->count = textParseDoublesSplit(parsers, fd, info.st_size, &values);
+    }//if
+
+    else{
+        file->count = textParseDoubles(fd, &values);
+    }//else
+
+    file->map = NULL;
+    file->mapLength = 0;
+    file->values = values;
+    file->type = DATA_F64;
+    file->swapped = false;
+    file->text = false;
+
+}//dataFileParseText
+
+/**
+ * Opens a data file. Binary files are mapped read-only and checked against their
+ * header; anything else is parsed as text, or only named if parse is false so it
+ * can be read in pieces later (by a text_stream on its name)
+ *
+ * @param file: filled in with where the numbers are
+ * @param filename: the file to open
+ * @param parsers: threads to parse a big text file with, or NULL
+ * @param parse: whether a text file is parsed now
+ * @return bool: false if the file doesn't exist or can't be read
+ */
+static inline bool dataFileOpenWith(data_file* file, const char* filename, worker_pool* parsers, bool parse){
+
+    int fd;
+    struct stat info;
+    data_header header;
+
+    //by a name that can be opened again, a redirected binary file is read like any other
+    if (strcmp(filename, DATA_STDIN) == 0){
+        filename = "/dev/stdin";
+    }//if
+
+    fd = open(filename, O_RDONLY);
+
+    if (fd < 0){
+        return false;
+    }//if
+
+    if (fstat(fd, &info) != 0){
+        close(fd);
+        return false;
+    }//if
+
+    if ((size_t) info.st_size < sizeof(data_header)
+            || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)
+            || memcmp(header.magic, DATA_MAGIC, 8) != 0){
+
+        //no header, must be text
+        if (parse){
+            dataFileParseText(file, fd, parsers);
+        }//if
+
+        else{
+            file->map = NULL;
+            file->mapLength = 0;
+            file->values = NULL;
+            file->count = 0;
+            file->type = DATA_F64;
+            file->swapped = false;
+            file->text = true;
+        }//else
+
+        file->name = strdup(filename);
+        close(fd);
+        return true;
+
+    }//if
+
+    file->swapped = (header.byteOrder != DATA_BYTE_ORDER);
+
+    if (file->swapped){
+        header.type = __builtin_bswap32(header.type);
+        header.count = __builtin_bswap64(header.count);
+    }//if
+
+    if (header.type < DATA_I32 || header.type > DATA_F64
+            || header.count > (info.st_size - sizeof(data_header)) / dataTypeSize(header.type)){
+        fprintf(stderr, "%s: bad data file header\n", filename);
+        exit(EXIT_FAILURE);
+    }//if
+
+    file->mapLength = info.st_size;
+    file->map = mmap(NULL, file->mapLength, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (file->map == MAP_FAILED){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    //the numbers are read front to back, once
+    madvise(file->map, file->mapLength, MADV_SEQUENTIAL);
+    madvise(file->map, file->mapLength, MADV_WILLNEED);
+
+    file->values = (const char *) file->map + sizeof(data_header);
+    file->count = header.count;
+    file->type = header.type;
+    file->text = false;
+    file->name = strdup(filename);
+
+    return true;
+
+}//dataFileOpenWith
+
+/**
+ * @param file: filled in with where the numbers are
+ * @param filename: the file to open
+ * @param parsers: threads to parse a big text file with, or NULL
+ * @return bool: false if the file doesn't exist or can't be read
+ */
+static inline bool dataFileOpenPool(data_file* file, const char* filename, worker_pool* parsers){
+    return dataFileOpenWith(file, filename, parsers, true);
+}//dataFileOpenPool
+
+/**
+ * @param file: filled in with where the numbers are
+ * @param filename: the file to open
+ * @return bool: false if the file doesn't exist or can't be read
+ */
+static inline bool dataFileOpen(data_file* file, const char* filename){
+    return dataFileOpenPool(file, filename, NULL);
+}//dataFileOpen
+
+/**
+ * @param file: filled in with where the numbers are, or just the name of a text file
+ * @param filename: the file to open
+ * @return bool: false if the file doesn't exist or can't be read
+ */
+static inline bool dataFileOpenLazy(data_file* file, const char* filename){
+    return dataFileOpenWith(file, filename, NULL, false);
+}//dataFileOpenLazy
+
+/**
+ * @param file: the file to close
+ * @return void
+ */
+static inline void dataFileClose(data_file* file){
+
+    if (file->map != NULL){
+        munmap(file->map, file->mapLength);
+    }//if
+
+    else{
+        free((void *) file->values);
+    }//else
+
+    free(file->name);
+
+}//dataFileClose
+
+/**
+ * Lets the kernel drop the pages of a mapped file holding numbers before end.
+ * Files read once from front to back (like by an external sort) then only keep
+ * the part still being read in memory, not everything read so far. Once a file
+ * is loaded whole, all of it goes
+ *
+ * @param file: a file opened by dataFileOpen
+ * @param end: every number before this one has been loaded
+ * @return void
+ */
+static inline void dataFileRelease(data_file* file, size_t end){
+
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t bytes = sizeof(data_header) + end * dataTypeSize(file->type);
+
+    //only whole pages, the one being read stays (unless it's all been read)
+    if (end < file->count){
+        bytes -= bytes % page;
+    }//if
+
+    else{
+        bytes = file->mapLength;
+    }//else
+
+    if (file->map != NULL && bytes > 0){
+        madvise(file->map, bytes, MADV_DONTNEED);
+    }//if
+
+}//dataFileRelease
+
+/**
+ * Writes numbers to a binary data file (replacing it if it exists)
+ *
+ * @param filename: file to write
+ * @param type: DATA_I32 ... DATA_F64, what values holds
+ * @param values: the numbers
+ * @param count: how many numbers
+ * @return void
+ */
+static inline void dataFileWrite(const char* filename, int type, const void* values, size_t count){
+
+    FILE* fp = fopen(filename, "wb");
+    data_header header;
+
+    if (fp == NULL){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    memcpy(header.magic, DATA_MAGIC, 8);
+    header.byteOrder = DATA_BYTE_ORDER;
+    header.type = type;
+    header.count = count;
+    header.reserved = 0;
+
+    if (fwrite(&header, sizeof(header), 1, fp) != 1
+            || fwrite(values, dataTypeSize(type), count, fp) != count){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    fclose(fp);
+
+}//dataFileWrite
+
+/**
+ * Opens the files data1 ... data<total>. For each one the binary dataN.bin is used
+ * if it exists, then the old text dataN.txt, and if neither exists dataN.bin is
+ * created and filled with numsPerFile random doubles between 0 and max.
+ * A file only depends on seed and its number, so the same seed always makes
+ * the same files. An unparsed text file isn't checked for numsPerFile numbers,
+ * it is read as it is
+ *
+ * @param files: filled in with the opened files
+ * @param total: how many files
+ * @param numsPerFile: how many numbers each file needs
+ * @param max: upper bound on the numbers generated
+ * @param seed: seed for the random numbers
+ * @param threads: how many threads fill a file
+ * @param parse: whether text files are parsed now
+ * @return void
+ */
+static inline void dataFilesOpen(data_file* files, int total, size_t numsPerFile, double max,
+        uint64_t seed, int threads, bool parse){
+
+    char filename[32];
+    double* values;
+    worker_pool fillers;
+    bool started = false; //fillers are only made if a file has to be
+    bool opened;
+
+    for (int i = 0 ; i < total ; i++){
+
+        sprintf(filename, "data%d.bin", i + 1);
+        opened = dataFileOpen(&files[i], filename);
+
+        //no binary file, try the old text one
+        if (!opened){
+            sprintf(filename, "data%d.txt", i + 1);
+            opened = dataFileOpenWith(&files[i], filename, NULL, parse);
+        }//if
+
+        //neither, make a binary one
+        if (!opened){
+
+            sprintf(filename, "data%d.bin", i + 1);
+            printf("Filling file %s (seed %llu)...\n", filename, (unsigned long long) seed);
+
+            values = malloc(sizeof(double) * numsPerFile);
+
+            if (values == NULL){
+                fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", numsPerFile);
+                exit(EXIT_FAILURE);
+            }//if
+
+            if (!started){
+                poolInit(&fillers, threads);
+                started = true;
+            }//if
+
+            //fill file with doubles with range 0 to max
+            randomFill_f64(&fillers, values, numsPerFile, max, randomStream(seed, i + 1));
+
+            dataFileWrite(filename, DATA_F64, values, numsPerFile);
+            free(values);
+
+            if (!dataFileOpen(&files[i], filename)){
+                perror("Error");
+                exit(EXIT_FAILURE);
+            }//if
+
+        }//if
+
+        if (!files[i].text && files[i].count < numsPerFile){
+            fprintf(stderr, "%s only has %zu numbers, %zu are needed\n",
+                filename, files[i].count, numsPerFile);
+            exit(EXIT_FAILURE);
+        }//if
+
+    }//for
+
+    if (started){
+        poolDestroy(&fillers);
+    }//if
+
+}//dataFilesOpen
+
+/**
+ * scandir filter, skips hidden files and . and ..
+ *
+ * @param entry: a directory entry
+ * @return int: non-zero to keep it
+ */
+static inline int dataFileVisible(const struct dirent* entry){
+    return entry->d_name[0] != '.';
+}//dataFileVisible
+
+/**
+ * Adds a name to a growing list of file names
+ *
+ * @param names: the list, reallocated as needed
+ * @param total: how many names are in it
+ * @param capacity: how many names fit
+ * @param name: the name to add (copied)
+ * @return void
+ */
+static inline void dataFilesAdd(char*** names, int* total, int* capacity, const char* name){
+
+    if (*total == *capacity){
+
+        *capacity = (*capacity == 0) ? 16 : *capacity * 2;
+        *names = realloc(*names, sizeof(char *) * *capacity);
+
+        if (*names == NULL){
+            fprintf(stderr, "Couldn't allocate memory for the file names\n");
+            exit(EXIT_FAILURE);
+        }//if
+
+    }//if
+
+    (*names)[*total] = strdup(name);
+
+    if ((*names)[*total] == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the file names\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    (*total)++;
+
+}//dataFilesAdd
+
+/**
+ * Makes the list of files to sort out of names given on the command line. A file
+ * is used as is; a directory gives every (non-hidden) file directly inside it,
+ * sorted by name so shards keep their order. "-" stands for standard input
+ *
+ * @param count: how many names were given
+ * @param paths: the names, files or directories
+ * @param names: set to a new list of file names, free with dataFilesFree
+ * @return int: how many files are in the list
+ */
+static inline int dataFilesList(int count, const char* paths[], char*** names){
+
+    struct stat info;
+    struct dirent** entries;
+    char* path;
+    int total = 0, capacity = 0, found;
+
+    *names = NULL;
+
+    for (int i = 0 ; i < count ; i++){
+
+        if (strcmp(paths[i], DATA_STDIN) == 0){
+            dataFilesAdd(names, &total, &capacity, paths[i]);
+            continue;
+        }//if
+
+        if (stat(paths[i], &info) != 0){
+            perror(paths[i]);
+            exit(EXIT_FAILURE);
+        }//if
+
+        if (!S_ISDIR(info.st_mode)){
+            dataFilesAdd(names, &total, &capacity, paths[i]);
+            continue;
+        }//if
+
+        found = scandir(paths[i], &entries, dataFileVisible, alphasort);
+
+        if (found < 0){
+            perror(paths[i]);
+            exit(EXIT_FAILURE);
+        }//if
+
+        for (int j = 0 ; j < found ; j++){
+
+            path = malloc(strlen(paths[i]) + strlen(entries[j]->d_name) + 2);
+
+            if (path == NULL){
+                fprintf(stderr, "Couldn't allocate memory for the file names\n");
+                exit(EXIT_FAILURE);
+            }//if
+
+            sprintf(path, "%s/%s", paths[i], entries[j]->d_name);
+
+            //only the files, not subdirectories
+            if (stat(path, &info) == 0 && S_ISREG(info.st_mode)){
+                dataFilesAdd(names, &total, &capacity, path);
+            }//if
+
+            free(path);
+            free(entries[j]);
+
+        }//for
+
+        free(entries);
+
+    }//for
+
+    return total;
+
+}//dataFilesList
+
+/**
+ * @param names: a list made by dataFilesList
+ * @param total: how many names are in it
+ * @return void
+ */
+static inline void dataFilesFree(char* names[], int total){
+
+    for (int i = 0 ; i < total ; i++){
+        free(names[i]);
+    }//for
+
+    free(names);
+
+}//dataFilesFree
+
+/**
+ * Opens every file in a list. Unlike dataFilesOpen nothing is made, a file that
+ * can't be opened is an error
+ *
+ * @param files: filled in with the opened files
+ * @param total: how many files
+ * @param names: their names
+ * @param threads: how many threads parse a big text file
+ * @param parse: whether text files are parsed now
+ * @return void
+ */
+static inline void dataFilesOpenNamed(data_file* files, int total, char* names[], int threads, bool parse){
+
+    worker_pool parsers;
+
+    if (parse && threads > 1){
+        poolInit(&parsers, threads);
+    }//if
+
+    for (int i = 0 ; i < total ; i++){
+
+        if (!dataFileOpenWith(&files[i], names[i], (parse && threads > 1) ? &parsers : NULL, parse)){
+            perror(names[i]);
+            exit(EXIT_FAILURE);
+        }//if
+
+    }//for
+
+    if (parse && threads > 1){
+        poolDestroy(&parsers);
+    }//if
+
+}//dataFilesOpenNamed
+
+/**
+ * Lays the files out one after another in one array
+ *
+ * @param files: the opened files
+ * @param total: how many files
+ * @param starts: set to where each file starts, total + 1 of them
+ * @return size_t: how many numbers there are in all the files
+ */
+static inline size_t dataFilesStarts(const data_file* files, int total, size_t* starts){
+
+    starts[0] = 0;
+
+    for (int i = 0 ; i < total ; i++){
+        starts[i + 1] = starts[i] + files[i].count;
+    }//for
+
+    return starts[total];
+
+}//dataFilesStarts
+
+/**
+ * Cuts every file into blocks of blockSize numbers (the last one of a file can
+ * be shorter), laid out one after another like dataFilesStarts. An empty file
+ * still gets one empty block, so every file has at least one
+ *
+ * @param files: the opened files
+ * @param total: how many files
+ * @param blockSize: numbers per block, 0 for one block per file
+ * @param firstBlock: set to file i's first block, total + 1 of them
+ * @param blockStarts: set to a new array (malloc) of where each block starts,
+ *                     one more than there are blocks
+ * @return int: how many blocks there are
+ */
+static inline int dataFilesBlocks(const data_file* files, int total, size_t blockSize, int* firstBlock,
+        size_t** blockStarts){
+
+    size_t start = 0;
+    size_t blocks = 0;
+    int b = 0;
+
+    for (int i = 0 ; i < total ; i++){
+        blocks += (blockSize > 0 && files[i].count > blockSize) ? (files[i].count + blockSize - 1) / blockSize : 1;
+    }//for
+
+    if (blocks > INT32_MAX){
+        fprintf(stderr, "Too many blocks, make them bigger\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    *blockStarts = malloc(sizeof(size_t) * (blocks + 1));
+
+    if (*blockStarts == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %zu blocks\n", blocks);
+        exit(EXIT_FAILURE);
+    }//if
+
+    for (int i = 0 ; i < total ; i++){
+
+        firstBlock[i] = b;
+        (*blockStarts)[b++] = start;
+
+        for (size_t n = blockSize ; blockSize > 0 && n < files[i].count ; n += blockSize){
+            (*blockStarts)[b++] = start + n;
+        }//for
+
+        start += files[i].count;
+
+    }//for
+
+    firstBlock[total] = b;
+    (*blockStarts)[b] = start;
+
+    return b;
+
+}//dataFilesBlocks
+
+//loads numbers of type SRC out of a file into T, swapping bytes with the 32/64 bit RAW if needed
+#define DATA_CONVERT(SRC, RAW, SWAP) \
+    if (!file->swapped){ \
+        const SRC* in = (const SRC *) file->values + first; \
+        for (size_t i = 0 ; i < count ; i++){ \
+            out[i] = (__typeof__(*out)) in[i]; \
+        } \
+    } \
+    else{ \
+        const RAW* in = (const RAW *) file->values + first; \
+        for (size_t i = 0 ; i < count ; i++){ \
+            RAW bits = SWAP(in[i]); \
+            SRC value; \
+            memcpy(&value, &bits, sizeof(value)); \
+            out[i] = (__typeof__(*out)) value; \
+        } \
+    }
+
+#define DATA_FILES_DEFINE(T, S, TYPE) \
+\
+static inline void dataFileLoad_##S(const data_file* file, size_t first, T* out, size_t count){ \
+    if (file->type == (TYPE) && !file->swapped){ \
+        memcpy(out, (const T *) file->values + first, sizeof(T) * count); \
+        return; \
+    } \
+    switch (file->type){ \
+        case DATA_I32: { DATA_CONVERT(int32_t, uint32_t, __builtin_bswap32) break; } \
+        case DATA_I64: { DATA_CONVERT(int64_t, uint64_t, __builtin_bswap64) break; } \
+        case DATA_U32: { DATA_CONVERT(uint32_t, uint32_t, __builtin_bswap32) break; } \
+        case DATA_U64: { DATA_CONVERT(uint64_t, uint64_t, __builtin_bswap64) break; } \
+        case DATA_F32: { DATA_CONVERT(float, uint32_t, __builtin_bswap32) break; } \
+        case DATA_F64: { DATA_CONVERT(double, uint64_t, __builtin_bswap64) break; } \
+    } \
+}
+
+DATA_FILES_DEFINE(int32_t, i32, DATA_I32)
+DATA_FILES_DEFINE(int64_t, i64, DATA_I64)
+DATA_FILES_DEFINE(uint32_t, u32, DATA_U32)
+DATA_FILES_DEFINE(uint64_t, u64, DATA_U64)
+DATA_FILES_DEFINE(float, f32, DATA_F32)
+DATA_FILES_DEFINE(double, f64, DATA_F64)
+
+#endif
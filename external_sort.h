@@ -0,0 +1,502 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * External Sort
+ *
+ * external_sort.h
+ *
+ * Sorting data files that don't fit in memory, using no more than a set budget
+ * of memory for the numbers
+ *
+ * The sort is done in two steps:
+ *
+ *  1. Runs: the files are streamed, in order, into a buffer. Every time it fills
+ *     up, each thread of the pool sorts its own chunk, the chunks are merged
+ *     together in place (parallel_merge.h), and the sorted buffer is written to
+ *     disk as a binary run (data_files.h). Binary files are copied out of their
+ *     maps, text files are parsed straight into the buffer a buffer's worth at a
+ *     time (text_io.h), so neither is ever held whole. The buffer is as big as the
+ *     budget allows once the merge's own memory (parallelMergeBytes) and the
+ *     text parser's buffer are taken out of it
+ *  2. Merge: every run gets a read buffer and the fronts of the runs play in a
+ *     tree of losers (loser_tree.h). Taking the winner and replaying its run with
+ *     the next number (refilling its buffer when it runs dry) repeats until every
+ *     run is empty, streaming the result out through the text writer, whose
+ *     buffer comes out of the budget too.
+ *     If there are so many runs that their buffers would be smaller than
+ *     EXTERNAL_MIN_BUFFER, groups of them are merged into bigger runs first
+ *
+ * Runs are read and written with read()/write() on big buffers, so the disk only
+ * ever sees long sequential transfers. They live in a temporary directory made in
+ * the working directory, and are removed when the sort is done
+ *
+ * Methods (one of each per type, T is the key type):
+ *  - externalSort_<type>(worker_pool* pool, data_file* files, int total, size_t budget,
+ *                        const char* filename) -> size_t
+ *      Sorts every number of every file, writing the result as text to filename,
+ *      returns how many numbers there were
+ *
+ *  - externalMakeRuns_<type>(worker_pool* pool, data_file* files, int total, size_t bufferKeys,
+ *                            const char* dir, char*** names, size_t* count) -> int
+ *      Writes sorted runs of bufferKeys numbers to dir, returns how many (and how
+ *      many numbers they hold in count)
+ *
+ *  - externalMergeKeys_<type>(size_t budget, int k) -> size_t
+ *      How many numbers each buffer of a k-way merge within budget bytes holds
+ *
+ *  - externalSortBuffer_<type>(worker_pool* pool, T* buffer, size_t n, size_t* starts) -> void
+ *      Sorts one buffer with every thread of the pool
+ *
+ *  - externalChunkJob_<type>(int rank, void* arg) -> void
+ *      Pool job, sorts one thread's chunk of the buffer
+ *
+ *  - externalMerge_<type>(char* names[], int k, size_t bufferKeys, text_writer* text,
+ *                         const char* filename) -> void
+ *      k-way merges runs into a new run called filename, or as text into text
+ *
+ *  - runReaderOpen_<type>, runReaderFill_<type>
+ *      Streaming a run in through a buffer
+ *
+ *  - runWriterOpen_<type>, runWriterFlush_<type>, runWriterClose_<type>
+ *      Streaming a run out through a buffer, the header is fixed up at the end
+ *
+ *  - externalMemoryOption(int argc, const char* argv[], size_t* budget) -> int
+ *      Takes "--memory MB" (or "--memory=MB") out of the arguments, returns the new argc.
+ *      budget is 0 if it isn't there. A --memory without a number is a usage error
+ *
+ *  - externalWriteAll(int fd, const void* data, size_t bytes) -> void
+ *      write() until everything is written
+ *
+ * Resources:
+ *  - Knuth, "The Art of Computer Programming, Volume 3", section 5.4
+ *      external sorting, k-way merging with a tree of losers
+ */
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "sort_core.h"
+#include "worker_pool.h"
+#include "parallel_merge.h"
+#include "data_files.h"
+#include "loser_tree.h"
+#include "text_io.h"
+
+#define EXTERNAL_MIN_BUFFER (1 << 16) //smallest read buffer a run gets while merging, bytes
+#define EXTERNAL_MIN_BUDGET (4 << 20) //smallest budget accepted, bytes (leaves room next to the text buffers)
+
+/**
+ * Looks for "--memory MB" or "--memory=MB" among the arguments and removes it, so
+ * the program can check the rest of its arguments like before. A --memory at the
+ * end, or with something that isn't a number, is reported and the program exits
+ *
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given, the memory option is taken out
+ * @param budget: set to the budget in bytes, or 0 if none was given
+ * @return int: argc without the memory option
+ */
+static inline int externalMemoryOption(int argc, const char* argv[], size_t* budget){
+
+    const char* value = NULL;
+    char* end;
+    int kept = 1;
+
+    for (int i = 1 ; i < argc ; i++){
+
+        if (strcmp(argv[i], "--memory") == 0){
+
+            if (i + 1 == argc){
+                fprintf(stderr, "usage:   %s ... --memory m, m is missing\n", argv[0]);
+                exit(EXIT_FAILURE);
+            }//if
+
+            value = argv[++i];
+
+        }//if
+
+        else if (strncmp(argv[i], "--memory=", 9) == 0){
+            value = argv[i] + 9;
+        }//else if
+
+        else{
+            argv[kept++] = argv[i];
+        }//else
+
+    }//for
+
+    *budget = (value != NULL) ? (size_t) strtoull(value, &end, 10) << 20 : 0;
+
+    if (value != NULL && (end == value || *end != '\0')){
+        fprintf(stderr, "usage:   %s ... --memory m, m has to be a number, not \"%s\"\n", argv[0], value);
+        exit(EXIT_FAILURE);
+    }//if
+
+    if (value != NULL && *budget < EXTERNAL_MIN_BUDGET){
+        *budget = EXTERNAL_MIN_BUDGET;
+    }//if
+
+    argv[kept] = NULL;
+
+    return kept;
+
+}//externalMemoryOption
+
+/**
+ * @param fd: file to write to
+ * @param data: what to write
+ * @param bytes: how much of it
+ * @return void
+ */
+static inline void externalWriteAll(int fd, const void* data, size_t bytes){
+
+    size_t done = 0;
+    ssize_t wrote;
+
+    while (done < bytes){
+
+        wrote = write(fd, (const char *) data + done, bytes - done);
+
+        if (wrote < 0){
+            perror("Error");
+            exit(EXIT_FAILURE);
+        }//if
+
+        done += wrote;
+
+    }//while
+
+}//externalWriteAll
+
+#define EXTERNAL_SORT_DEFINE(T, S, TYPE) \
+\
+/* a run being read, buffer[next, filled) hasn't been used yet */ \
+typedef struct { \
+    int fd; \
+    T* buffer; \
+    size_t capacity; \
+    size_t next; \
+    size_t filled; \
+} run_reader_##S; \
+\
+/* a run being written */ \
+typedef struct { \
+    int fd; \
+    T* buffer; \
+    size_t capacity; \
+    size_t used; \
+    uint64_t count; \
+} run_writer_##S; \
+\
+/* what every thread needs to sort its chunk of a buffer */ \
+typedef struct { \
+    T* buffer; \
+    const size_t* starts; \
+} external_chunk_data_##S; \
+\
+static inline bool runReaderFill_##S(run_reader_##S* reader){ \
+    size_t bytes = 0; \
+    ssize_t got; \
+    while (bytes < sizeof(T) * reader->capacity){ \
+        got = read(reader->fd, (char *) reader->buffer + bytes, sizeof(T) * reader->capacity - bytes); \
+        if (got < 0){ \
+            perror("Error"); \
+            exit(EXIT_FAILURE); \
+        } \
+        if (got == 0){ \
+            break; \
+        } \
+        bytes += got; \
+    } \
+    reader->next = 0; \
+    reader->filled = bytes / sizeof(T); \
+    return reader->filled > 0; \
+} \
+\
+static inline void runReaderOpen_##S(run_reader_##S* reader, const char* filename, T* buffer, size_t capacity){ \
+    data_header header; \
+    reader->fd = open(filename, O_RDONLY); \
+    if (reader->fd < 0 || read(reader->fd, &header, sizeof(header)) != (ssize_t) sizeof(header) \
+            || memcmp(header.magic, DATA_MAGIC, 8) != 0 || header.type != (TYPE)){ \
+        fprintf(stderr, "%s: bad run file\n", filename); \
+        exit(EXIT_FAILURE); \
+    } \
+    posix_fadvise(reader->fd, 0, 0, POSIX_FADV_SEQUENTIAL); \
+    reader->buffer = buffer; \
+    reader->capacity = capacity; \
+    runReaderFill_##S(reader); \
+} \
+\
+static inline void runWriterOpen_##S(run_writer_##S* writer, const char* filename, T* buffer, size_t capacity){ \
+    data_header header; \
+    writer->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666); \
+    if (writer->fd < 0){ \
+        perror("Error"); \
+        exit(EXIT_FAILURE); \
+    } \
+    /* the count is filled in by runWriterClose */ \
+    memset(&header, 0, sizeof(header)); \
+    memcpy(header.magic, DATA_MAGIC, 8); \
+    header.byteOrder = DATA_BYTE_ORDER; \
+    header.type = (TYPE); \
+    externalWriteAll(writer->fd, &header, sizeof(header)); \
+    writer->buffer = buffer; \
+    writer->capacity = capacity; \
+    writer->used = 0; \
+    writer->count = 0; \
+} \
+\
+static inline void runWriterFlush_##S(run_writer_##S* writer){ \
+    externalWriteAll(writer->fd, writer->buffer, sizeof(T) * writer->used); \
+    writer->count += writer->used; \
+    writer->used = 0; \
+} \
+\
+static inline void runWriterClose_##S(run_writer_##S* writer){ \
+    runWriterFlush_##S(writer); \
+    if (pwrite(writer->fd, &writer->count, sizeof(writer->count), offsetof(data_header, count)) \
+            != (ssize_t) sizeof(writer->count)){ \
+        perror("Error"); \
+        exit(EXIT_FAILURE); \
+    } \
+    close(writer->fd); \
+} \
+\
+static void externalChunkJob_##S(int rank, void* arg){ \
+    external_chunk_data_##S* data = (external_chunk_data_##S *) arg; \
+    size_t start = data->starts[rank]; \
+    quickSort_##S(&data->buffer[start], 0, (ptrdiff_t) (data->starts[rank + 1] - start) - 1); \
+} \
+\
+static inline void externalSortBuffer_##S(worker_pool* pool, T* buffer, size_t n, size_t* starts){ \
+    external_chunk_data_##S data; \
+    int p = pool->thread_count; \
+    for (int r = 0 ; r <= p ; r++){ \
+        starts[r] = chunkStart(r, p, n); \
+    } \
+    data.buffer = buffer; \
+    data.starts = starts; \
+    poolRun(pool, externalChunkJob_##S, &data); \
+    if (p > 1){ \
+        parallelMerge_##S(pool, buffer, starts, p); \
+    } \
+} \
+\
+static inline int externalMakeRuns_##S(worker_pool* pool, data_file* files, int total, size_t bufferKeys, \
+        const char* dir, char*** names, size_t* count){ \
+    T* buffer = malloc(sizeof(T) * bufferKeys); \
+    size_t* starts = malloc(sizeof(size_t) * (pool->thread_count + 1)); \
+    char* filename = malloc(strlen(dir) + 32); \
+    size_t n, take, offset = 0; \
+    int file = 0, runs = 0, capacity = 0, fd = -1; \
+    text_stream stream; /* the text file being read, while fd is open */ \
+    if (buffer == NULL || starts == NULL || filename == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the sort buffers\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    *names = NULL; \
+    *count = 0; \
+    while (true){ \
+        /* fill the buffer, carrying on through as many files as it takes */ \
+        for (n = 0 ; n < bufferKeys && file < total ; ){ \
+            /* text is parsed as it's needed, from where the last buffer stopped; */ \
+            /* a short parse means the file has ended */ \
+            if (files[file].text){ \
+                if (fd < 0){ \
+                    fd = open(files[file].name, O_RDONLY); \
+                    if (fd < 0){ \
+                        perror(files[file].name); \
+                        exit(EXIT_FAILURE); \
+                    } \
+                    textStreamInit(&stream, fd); \
+                } \
+                take = textStreamNext_##S(&stream, &buffer[n], bufferKeys - n); \
+                n += take; \
+                if (n < bufferKeys){ \
+                    textStreamClose(&stream); \
+                    close(fd); \
+                    fd = -1; \
+                    file++; \
+                } \
+                continue; \
+            } \
+            take = files[file].count - offset; \
+            take = (take < bufferKeys - n) ? take : bufferKeys - n; \
+            dataFileLoad_##S(&files[file], offset, &buffer[n], take); \
+            n += take; \
+            offset += take; \
+            dataFileRelease(&files[file], offset); \
+            if (offset == files[file].count){ \
+                file++; \
+                offset = 0; \
+            } \
+        } \
+        if (n == 0){ \
+            break; \
+        } \
+        *count += n; \
+        externalSortBuffer_##S(pool, buffer, n, starts); \
+        sprintf(filename, "%s/run%d.bin", dir, runs); \
+        dataFileWrite(filename, (TYPE), buffer, n); \
+        dataFilesAdd(names, &runs, &capacity, filename); \
+    } \
+    free(buffer); \
+    free(starts); \
+    free(filename); \
+    return runs; \
+} \
+\
+/* the buffers of a k-way merge share what is left of budget once the readers and */ \
+/* the tree (with what it is built from) have theirs */ \
+static inline size_t externalMergeKeys_##S(size_t budget, int k){ \
+    size_t others = (k + 1) * (sizeof(run_reader_##S) + sizeof(T) + sizeof(bool) \
+        + 6 * sizeof(loser_entry_##S)); \
+    return (budget > others) ? (budget - others) / (sizeof(T) * (k + 1)) : 1; \
+} \
+\
+static inline void externalMerge_##S(char* names[], int k, size_t bufferKeys, text_writer* text, \
+        const char* filename){ \
+    run_reader_##S* readers = malloc(sizeof(run_reader_##S) * (k + 1)); \
+    T* buffers = malloc(sizeof(T) * bufferKeys * (k + 1)); \
+    T* fronts = malloc(sizeof(T) * (k + 1)); \
+    bool* has = malloc(sizeof(bool) * (k + 1)); \
+    T* out = &buffers[bufferKeys * k]; /* the last buffer collects the output */ \
+    run_writer_##S writer; \
+    loser_tree_##S tree; \
+    size_t used = 0; \
+    int r; \
+    if (readers == NULL || buffers == NULL || fronts == NULL || has == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    if (text == NULL){ \
+        runWriterOpen_##S(&writer, filename, out, bufferKeys); \
+    } \
+    /* the front of every run goes in the tree */ \
+    for (r = 0 ; r < k ; r++){ \
+        runReaderOpen_##S(&readers[r], names[r], &buffers[bufferKeys * r], bufferKeys); \
+        has[r] = readers[r].filled > 0; \
+        if (has[r]){ \
+            fronts[r] = readers[r].buffer[readers[r].next++]; \
+        } \
+    } \
+    loserTreeInit_##S(&tree, fronts, has, k); \
+    while (!loserTreeEmpty_##S(&tree)){ \
+        out[used++] = tree.winner.key; \
+        if (used == bufferKeys){ \
+            if (text == NULL){ \
+                writer.used = used; \
+                runWriterFlush_##S(&writer); \
+            } \
+            else{ \
+                textWriteNumbers_##S(text, out, used); \
+            } \
+            used = 0; \
+        } \
+        /* the winner's run plays on with its next number, or drops out */ \
+        r = tree.winner.run; \
+        if (readers[r].next < readers[r].filled || runReaderFill_##S(&readers[r])){ \
+            loserTreeReplace_##S(&tree, readers[r].buffer[readers[r].next++]); \
+        } \
+        else{ \
+            loserTreeDrop_##S(&tree); \
+        } \
+    } \
+    if (text == NULL){ \
+        writer.used = used; \
+        runWriterClose_##S(&writer); \
+    } \
+    else if (used > 0){ \
+        textWriteNumbers_##S(text, out, used); \
+    } \
+    for (r = 0 ; r < k ; r++){ \
+        close(readers[r].fd); \
+    } \
+    loserTreeFree_##S(&tree); \
+    free(readers); \
+    free(buffers); \
+    free(fronts); \
+    free(has); \
+} \
+\
+static inline size_t externalSort_##S(worker_pool* pool, data_file* files, int total, size_t budget, \
+        const char* filename){ \
+    char dir[] = "sortRunsXXXXXX"; \
+    char** names; \
+    char** merged; \
+    char* runName = malloc(sizeof(dir) + 32); \
+    int p = pool->thread_count; \
+    /* the result's text goes out through a buffer of its own */ \
+    size_t outBudget = budget - TEXT_OUT_BLOCK, runBudget = budget, bufferKeys, count; \
+    int k, made, next, group, fanIn = (int) (outBudget / EXTERNAL_MIN_BUFFER) - 1; \
+    text_writer out; \
+    if (runName == NULL || mkdtemp(dir) == NULL){ \
+        perror("Error"); \
+        exit(EXIT_FAILURE); \
+    } \
+    /* text files are parsed through a buffer of their own */ \
+    for (int f = 0 ; f < total ; f++){ \
+        if (files[f].text){ \
+            runBudget -= TEXT_BLOCK + TEXT_MAX_TOKEN + TEXT_PAD; \
+            break; \
+        } \
+    } \
+    /* the rest is the numbers and whatever merging them takes */ \
+    bufferKeys = runBudget / sizeof(T); \
+    while (bufferKeys > 1 && sizeof(T) * bufferKeys + parallelMergeBytes_##S(bufferKeys, p, p) > runBudget){ \
+        bufferKeys -= bufferKeys / 32 + 1; \
+    } \
+    k = externalMakeRuns_##S(pool, files, total, bufferKeys, dir, &names, &count); \
+    made = k; \
+    /* too many runs for a big enough buffer each, merge groups of them first */ \
+    while (k > fanIn){ \
+        merged = malloc(sizeof(char *) * ((k + fanIn - 1) / fanIn)); \
+        if (merged == NULL){ \
+            fprintf(stderr, "Couldn't allocate memory for the run names\n"); \
+            exit(EXIT_FAILURE); \
+        } \
+        next = 0; \
+        for (int g = 0 ; g < k ; g += fanIn){ \
+            group = (k - g < fanIn) ? k - g : fanIn; \
+            if (group == 1){ \
+                merged[next++] = names[g]; \
+                continue; \
+            } \
+            sprintf(runName, "%s/run%d.bin", dir, made++); \
+            externalMerge_##S(&names[g], group, externalMergeKeys_##S(budget, group), NULL, runName); \
+            for (int r = g ; r < g + group ; r++){ \
+                unlink(names[r]); \
+                free(names[r]); \
+            } \
+            merged[next++] = strdup(runName); \
+        } \
+        free(names); \
+        names = merged; \
+        k = next; \
+    } \
+    textWriterOpen(&out, filename); \
+    externalMerge_##S(names, k, externalMergeKeys_##S(outBudget, k), &out, NULL); \
+    textWriterClose(&out); \
+    for (int r = 0 ; r < k ; r++){ \
+        unlink(names[r]); \
+    } \
+    dataFilesFree(names, k); \
+    rmdir(dir); \
+    free(runName); \
+    return count; \
+}
+
+EXTERNAL_SORT_DEFINE(int32_t, i32, DATA_I32)
+EXTERNAL_SORT_DEFINE(int64_t, i64, DATA_I64)
+EXTERNAL_SORT_DEFINE(uint32_t, u32, DATA_U32)
+EXTERNAL_SORT_DEFINE(uint64_t, u64, DATA_U64)
+EXTERNAL_SORT_DEFINE(float, f32, DATA_F32)
+EXTERNAL_SORT_DEFINE(double, f64, DATA_F64)
+
+#endif
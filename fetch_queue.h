@@ -0,0 +1,287 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Asynchronous Reads
+ *
+ * fetch_queue.h
+ *
+ * Bounded lock-free queue of block numbers, from the reader threads to the sort
+ *
+ * Any number of threads can push and pop at once. Every cell of the ring carries
+ * a sequence number saying whose turn it is: a pusher may fill cell i when its
+ * sequence is the position it claimed, a popper may empty it when the sequence is
+ * one past that, and emptying it hands it on to the pusher one lap later. A thread
+ * claims a position with one compare-and-swap, so nobody ever waits on a lock held
+ * by a thread that got descheduled, and the only shared writes are the two positions
+ * and the cell itself
+ *
+ * The queue is bounded, so readers that get too far ahead of the sort stop instead
+ * of filling memory. A thread that finds it full (or empty) sleeps on a futex until
+ * a pop (or a push) happens; waits here are as long as a read or a sort, so there is
+ * no spinning first
+ *
+ * Methods:
+ *  - fetchQueueInit(fetch_queue* queue, int capacity) -> void
+ *      Sets up an empty queue for at least capacity items (rounded up to a power of two)
+ *
+ *  - fetchQueueDestroy(fetch_queue* queue) -> void
+ *      Frees the cells
+ *
+ *  - fetchQueueTryPush(fetch_queue* queue, int item) -> bool
+ *      Adds item at the back, false if the queue is full
+ *
+ *  - fetchQueueTryPop(fetch_queue* queue, int* item) -> bool
+ *      Takes the item at the front, false if the queue is empty
+ *
+ *  - fetchQueuePush(fetch_queue* queue, int item) -> void
+ *      Adds item, sleeping while the queue is full
+ *
+ *  - fetchQueuePop(fetch_queue* queue) -> int
+ *      Takes an item, sleeping while the queue is empty
+ *
+ *  - fetchQueueSleep(atomic_int* word, int seen, atomic_int* sleepers) -> void
+ *      Sleeps until word isn't seen anymore
+ *
+ *  - fetchQueueWake(atomic_int* word, atomic_int* sleepers) -> void
+ *      Bumps word and wakes whoever sleeps on it
+ *
+ * Resources:
+ *  - Dmitry Vyukov, "Bounded MPMC queue" (1024cores.net)
+ *      the per-cell sequence numbers
+ */
+#ifndef FETCH_QUEUE_H
+#define FETCH_QUEUE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "spin_barrier.h"
+
+typedef struct {
+    atomic_size_t sequence;
+    int item;
+} fetch_cell;
+
+typedef struct {
+    fetch_cell* cells;
+    size_t mask; //capacity - 1
+    _Alignas(CACHE_LINE) atomic_size_t tail; //next position to push to
+    _Alignas(CACHE_LINE) atomic_size_t head; //next position to pop from
+    _Alignas(CACHE_LINE) atomic_int pushes; //futex words, bumped after every push or pop
+    atomic_int pops;
+    atomic_int pushSleepers; //threads waiting for room
+    atomic_int popSleepers; //threads waiting for an item
+} fetch_queue;
+
+/**
+ * @param queue: the queue to set up
+ * @param capacity: most items held at once, at least 1
+ * @return void
+ */
+static inline void fetchQueueInit(fetch_queue* queue, int capacity){
+
+    size_t cells = 1;
+
+    while (cells < (size_t) capacity){
+        cells *= 2;
+    }//while
+
+    queue->cells = malloc(sizeof(fetch_cell) * cells);
+
+    if (queue->cells == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the queue\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    //cell i is first filled by whoever claims position i
+    for (size_t i = 0 ; i < cells ; i++){
+        atomic_init(&queue->cells[i].sequence, i);
+    }//for
+
+    queue->mask = cells - 1;
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->pushes, 0);
+    atomic_init(&queue->pops, 0);
+    atomic_init(&queue->pushSleepers, 0);
+    atomic_init(&queue->popSleepers, 0);
+
+}//fetchQueueInit
+
+/**
+ * @param queue: the queue to clean up
+ * @return void
+ */
+static inline void fetchQueueDestroy(fetch_queue* queue){
+    free(queue->cells);
+}//fetchQueueDestroy
+
+/**
+ * Sleeps until word changes from seen (or returns straight away if it already has)
+ *
+ * @param word: the futex word
+ * @param seen: what it was when the queue was found full or empty
+ * @param sleepers: counts the threads asleep on word
+ * @return void
+ */
+static inline void fetchQueueSleep(atomic_int* word, int seen, atomic_int* sleepers){
+#ifdef __linux__
+    atomic_fetch_add(sleepers, 1);
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+    atomic_fetch_sub(sleepers, 1);
+#else
+    (void) word;
+    (void) seen;
+    (void) sleepers;
+    sched_yield();
+#endif
+}//fetchQueueSleep
+
+/**
+ * @param word: the futex word to bump
+ * @param sleepers: counts the threads asleep on word
+ * @return void
+ */
+static inline void fetchQueueWake(atomic_int* word, atomic_int* sleepers){
+
+    atomic_fetch_add(word, 1);
+
+#ifdef __linux__
+    if (atomic_load(sleepers) > 0){
+        syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }//if
+#else
+    (void) sleepers;
+#endif
+
+}//fetchQueueWake
+
+/**
+ * @param queue: the queue
+ * @param item: what to add
+ * @return bool: false if the queue is full
+ */
+static inline bool fetchQueueTryPush(fetch_queue* queue, int item){
+
+    size_t position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    fetch_cell* cell;
+    intptr_t turn;
+
+    while (true){
+
+        cell = &queue->cells[position & queue->mask];
+        turn = (intptr_t) atomic_load_explicit(&cell->sequence, memory_order_acquire) - (intptr_t) position;
+
+        //the cell is free for this position, try to claim it
+        if (turn == 0){
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &position, position + 1,
+                    memory_order_relaxed, memory_order_relaxed)){
+                break;
+            }//if
+        }//if
+
+        //still holds the item from a lap ago
+        else if (turn < 0){
+            return false;
+        }//else if
+
+        //somebody else claimed it first
+        else{
+            position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }//else
+
+    }//while
+
+    cell->item = item;
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+
+    return true;
+
+}//fetchQueueTryPush
+
+/**
+ * @param queue: the queue
+ * @param item: set to the item taken
+ * @return bool: false if the queue is empty
+ */
+static inline bool fetchQueueTryPop(fetch_queue* queue, int* item){
+
+    size_t position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    fetch_cell* cell;
+    intptr_t turn;
+
+    while (true){
+
+        cell = &queue->cells[position & queue->mask];
+        turn = (intptr_t) atomic_load_explicit(&cell->sequence, memory_order_acquire) - (intptr_t) (position + 1);
+
+        //the cell has been filled for this position, try to claim it
+        if (turn == 0){
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &position, position + 1,
+                    memory_order_relaxed, memory_order_relaxed)){
+                break;
+            }//if
+        }//if
+
+        //not filled yet
+        else if (turn < 0){
+            return false;
+        }//else if
+
+        else{
+            position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }//else
+
+    }//while
+
+    *item = cell->item;
+
+    //free for the pusher one lap later
+    atomic_store_explicit(&cell->sequence, position + queue->mask + 1, memory_order_release);
+
+    return true;
+
+}//fetchQueueTryPop
+
+/**
+ * @param queue: the queue
+ * @param item: what to add
+ * @return void
+ */
+static inline void fetchQueuePush(fetch_queue* queue, int item){
+
+    int seen = atomic_load(&queue->pops);
+
+    //the pops word is read before trying, so a pop in between wakes us straight away
+    while (!fetchQueueTryPush(queue, item)){
+        fetchQueueSleep(&queue->pops, seen, &queue->pushSleepers);
+        seen = atomic_load(&queue->pops);
+    }//while
+
+    fetchQueueWake(&queue->pushes, &queue->popSleepers);
+
+}//fetchQueuePush
+
+/**
+ * @param queue: the queue
+ * @return int: the item taken
+ */
+static inline int fetchQueuePop(fetch_queue* queue){
+
+    int seen = atomic_load(&queue->pushes);
+    int item;
+
+    while (!fetchQueueTryPop(queue, &item)){
+        fetchQueueSleep(&queue->pushes, seen, &queue->popSleepers);
+        seen = atomic_load(&queue->pushes);
+    }//while
+
+    fetchQueueWake(&queue->pops, &queue->pushSleepers);
+
+    return item;
+
+}//fetchQueuePop
+
+#endif
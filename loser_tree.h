@@ -0,0 +1,165 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Merging
+ *
+ * loser_tree.h
+ *
+ * Tree of losers (tournament tree) for k-way merging of sorted runs
+ *
+ * Every run is a leaf of a complete binary tree; every inner node remembers the
+ * player that lost the match played there, and the overall winner (the smallest
+ * front number of all the runs) sits on top. Once the winner's number is taken,
+ * its run plays again with its next number, and only the matches on the path from
+ * its leaf to the root are replayed, against the stored losers: log2(k)
+ * comparisons per number. A binary heap needs about twice that, comparing both
+ * children at every level on the way down
+ *
+ * Every player carries its number and its run, so a match never has to look
+ * anything up. A run that runs out plays on as the largest number of the type
+ * with a run number past every real run, so it loses every match (even against
+ * real numbers equal to it) and the replay never checks for empty runs. The
+ * padding up to a power of two leaves starts out that way. Equal numbers are won
+ * by the lower run, so the merge is stable
+ *
+ * The tree only sees front numbers, so the caller streams the runs in however it
+ * likes (from memory, or through read buffers from disk):
+ *
+ *      loserTreeInit(&tree, fronts, has, k);
+ *      while (!loserTreeEmpty(&tree)){
+ *          r = tree.winner.run;             take tree.winner.key from run r
+ *          if (run r has another number x)  loserTreeReplace(&tree, x);
+ *          else                             loserTreeDrop(&tree);
+ *      }
+ *
+ * Methods (one of each per type, T is the key type):
+ *  - loserTreeInit_<type>(loser_tree* tree, const T* fronts, const bool* has, int k) -> void
+ *      Plays the first tournament; run r starts at fronts[r] if has[r], else it is empty
+ *
+ *  - loserTreeReplace_<type>(loser_tree* tree, T key) -> void
+ *      The winner's run plays on with key
+ *
+ *  - loserTreeDrop_<type>(loser_tree* tree) -> void
+ *      The winner's run is out of numbers
+ *
+ *  - loserTreeEmpty_<type>(const loser_tree* tree) -> bool
+ *      Whether every run is out of numbers
+ *
+ *  - loserTreeFree_<type>(loser_tree* tree) -> void
+ *      Frees the tree
+ *
+ *  - loserTreeReplay_<type>(loser_tree* tree, int run, loser_entry player) -> void
+ *      Replays the matches from run's leaf to the root with player
+ *
+ *  - loserBeats_<type>(loser_entry a, loser_entry b) -> bool
+ *      Whether player a wins a match against player b
+ *
+ * Resources:
+ *  - Knuth, "The Art of Computer Programming, Volume 3", section 5.4.1
+ *      replacement selection and trees of losers
+ */
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#define LOSER_TREE_DEFINE(T, S, LAST) \
+\
+/* a player: the front number of a run and which run it is */ \
+typedef struct { \
+    T key; \
+    int run; \
+} loser_entry_##S; \
+\
+typedef struct { \
+    loser_entry_##S* losers; /* losers[1 ... leaves - 1], losers[0] is unused */ \
+    loser_entry_##S winner; \
+    int leaves; \
+} loser_tree_##S; \
+\
+static inline bool loserBeats_##S(loser_entry_##S a, loser_entry_##S b){ \
+    return a.key < b.key || (a.key == b.key && a.run < b.run); \
+} \
+\
+static inline void loserTreeInit_##S(loser_tree_##S* tree, const T* fronts, const bool* has, int k){ \
+    int leaves = 1; \
+    loser_entry_##S* winners; /* who won at every node, only needed to build the tree */ \
+    while (leaves < k){ \
+        leaves *= 2; \
+    } \
+    tree->leaves = leaves; \
+    tree->losers = malloc(sizeof(loser_entry_##S) * leaves); \
+    winners = malloc(sizeof(loser_entry_##S) * 2 * leaves); \
+    if (tree->losers == NULL || winners == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge tree\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    for (int r = 0 ; r < leaves ; r++){ \
+        if (r < k && has[r]){ \
+            winners[leaves + r].key = fronts[r]; \
+            winners[leaves + r].run = r; \
+        } \
+        else{ \
+            winners[leaves + r].key = (LAST); \
+            winners[leaves + r].run = leaves + r; \
+        } \
+    } \
+    /* first tournament, bottom up */ \
+    for (int node = leaves - 1 ; node >= 1 ; node--){ \
+        if (loserBeats_##S(winners[2 * node], winners[2 * node + 1])){ \
+            winners[node] = winners[2 * node]; \
+            tree->losers[node] = winners[2 * node + 1]; \
+        } \
+        else{ \
+            winners[node] = winners[2 * node + 1]; \
+            tree->losers[node] = winners[2 * node]; \
+        } \
+    } \
+    tree->winner = winners[1]; \
+    free(winners); \
+} \
+\
+static inline void loserTreeReplay_##S(loser_tree_##S* tree, int run, loser_entry_##S player){ \
+    loser_entry_##S loser; \
+    for (int node = (run + tree->leaves) / 2 ; node >= 1 ; node /= 2){ \
+        loser = tree->losers[node]; \
+        if (loserBeats_##S(loser, player)){ \
+            tree->losers[node] = player; \
+            player = loser; \
+        } \
+    } \
+    tree->winner = player; \
+} \
+\
+static inline void loserTreeReplace_##S(loser_tree_##S* tree, T key){ \
+    tree->winner.key = key; \
+    loserTreeReplay_##S(tree, tree->winner.run, tree->winner); \
+} \
+\
+static inline void loserTreeDrop_##S(loser_tree_##S* tree){ \
+    int run = tree->winner.run; \
+    tree->winner.key = (LAST); \
+    tree->winner.run = tree->leaves + run; \
+    loserTreeReplay_##S(tree, run, tree->winner); \
+} \
+\
+static inline bool loserTreeEmpty_##S(const loser_tree_##S* tree){ \
+    return tree->winner.run >= tree->leaves; \
+} \
+\
+static inline void loserTreeFree_##S(loser_tree_##S* tree){ \
+    free(tree->losers); \
+}
+
+LOSER_TREE_DEFINE(int32_t, i32, INT32_MAX)
+LOSER_TREE_DEFINE(int64_t, i64, INT64_MAX)
+LOSER_TREE_DEFINE(uint32_t, u32, UINT32_MAX)
+LOSER_TREE_DEFINE(uint64_t, u64, UINT64_MAX)
+LOSER_TREE_DEFINE(float, f32, INFINITY)
+LOSER_TREE_DEFINE(double, f64, INFINITY)
+
+#endif
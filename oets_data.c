@@ -1,416 +1,437 @@
-/**
- * AUCSC 310/450
- * Combined Term Project
- * Odd-Even Transposition Sort
- * 
- * oet_data.c
- * 
- * Serial and parallel data level implementation of odd-even transposition sort with PThreads
- * 
- * Generates an array of ints into memory based on the arguments from the command line. 
- * Then odd-even transpostion sort is used to serially or parallely sort the array
- * 
- * Implementation is data level because the sorting threads have all the data in the array
- * split up among them: there are no other task going on at the same time
- * 
- * The time to sort is recorded and printed to stdout
- * 
- * This implementation has more global variables than task level implementation.
- * This should be changed, but it doesn't really matter for something this trivial
- * 
- * Methods:
- *  - main(int argc, const char* argv[]) -> int
- *      Creates a globally avaliable array and executes the sort serially
- *      or paralelly based on args
- *  
- *  - serialOddEven(int arraySize) -> void
- *      Serial implementation of odd-even transposition sort.
- *      Operates on a globally avaliable array
- * 
- *  - parallelOddEven(int arraySize) -> void
- *      Parallel implementation of odd-even transposition sort using Pthreads.
- *      Operates on a globlly avaliable array, and creates array size / 2 threads
- * 
- *  - oddEvenStep(void *arg) -> void*
- *      The work each thread in the parallel implementation must do
- * 
- *  - swap(int x, int y) -> void
- *      Swaps the elements at indices x and y in the global array
- * 
- *  - printArray(int* array, int size) -> void
- *      Prints an array on a single line
- * 
- *  - Usage(const char* prog_name) -> void
- *      Prints to stderr how to use the program (its calling format)
- * 
- * 
- * Resources:
- *  - https://github.com/Nalaka1693/pthread_odd_even_sort/blob/master/odd-even-sort.c
- *      I found this guys implementation, which helped me structure my implementation quite
- *      a bit. Especially for how the threads will work, I thought I'd be stuck with
- *      array size / 2 threads (too much overhead)
- * 
- * Started November 13, 2019
- * Completed November 14, 2019
- * 
- * Keegan Petreman (petreman@ualberta.ca)
- * 1528679
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <float.h>
-#include <time.h>
-#include <sys/time.h>
-#include <stdbool.h>
-#include <string.h>
-#include <pthread.h>
-
-//Constants
-#define MAX 1000 //set the upper bound for numbers generated
-
-//Function Prototypes
-void serialOddEven(int arraySize);
-void parallelOddEven(int arraySize);
-void* oddEvenStep(void* arg);
-void swap(int x, int y);
-void printArray(int* array, int size);
-void Usage(const char* prog_name);
-
-//Global Variables
-int thread_count;
-int* array;
-pthread_barrier_t barrier;
-pthread_mutex_t mutex;
-bool global_swapped = true;
-double elapsed = 0;
-
-//struct: data for each thread
-typedef struct {
-    int myStart;
-    int myEnd;
-    int arraySize;
-} thread_data;
-
-/**
- * Preps the call to odd-even transpostion sort by first checking arguments,
- * and generating an array based on what size was provided. Then execution is
- * done serially or parallely based on args
- * 
- * @param argc: number of arguments given
- * @param argv[]: the arguments given
- * @return int
- */ 
-int main(int argc, const char* argv[]){
-
-    int arraySize;
-    bool parallel = true;
-    struct timespec stop, start;
-
-    //check arguments
-    switch (argc){
-
-        case 1:
-            arraySize = 8;
-            thread_count = 2;
-            break;
-
-        case 2:
-            
-            if (0 == strcmp(argv[1], "-s")){
-                parallel = false;
-                arraySize = 8;
-                thread_count = 1;
-            }//if
-
-            else{
-                //get size of array from command line
-                arraySize = strtol(argv[1], NULL, 10);
-                thread_count = 2;
-            }//else
-
-            break;
-
-        case 3:
-            
-            if (0 == strcmp(argv[1], "-s")){
-                parallel = false;
-                arraySize = strtol(argv[2], NULL, 10);
-                thread_count = 1;
-            }//if
-
-            else{
-                //get size of array from command line
-                arraySize = strtol(argv[1], NULL, 10);
-                thread_count = strtol(argv[2], NULL, 10);
-            }//else
-
-            break;   
-
-        default:
-            Usage(argv[0]);
-            return EXIT_SUCCESS;   
-
-    }//switch
-
-    if (arraySize % thread_count != 0){
-        fprintf(stderr, "Please only use array sizes that" 
-        "can easily be divided by the thread count (defualt is %d)\n", thread_count);
-        return EXIT_SUCCESS;
-    }//if
-
-    array = malloc(sizeof(int) * arraySize);
-
-    srand((unsigned) time(NULL));
-
-    //fill the array with random ints between 0 and MAX
-    for (int i = 0 ; i < arraySize ; i++){
-        array[i] =  (double)rand() / (double)(RAND_MAX / MAX);
-    }//for
-
-    if (parallel && thread_count > 1){
-        
-        parallelOddEven(arraySize);
-
-        printf("\nParallel time on array of size %d (%d threads):\n"
-            "%f seconds\n", arraySize, 
-            thread_count, elapsed);
-
-    }//if
-
-    else{
-
-        clock_gettime(CLOCK_MONOTONIC, &start);
-        serialOddEven(arraySize);
-        clock_gettime(CLOCK_MONOTONIC, &stop);
-
-        elapsed = (stop.tv_sec - start.tv_sec);
-        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
-
-        printf("\nSerial time on array of size %d:\n"
-            "%f seconds\n", arraySize, elapsed);
-
-    }//else
-
-    free(array); 
-
-    return EXIT_SUCCESS;
-
-}//main
-
-/**
- * Serial implementation of odd-even transposition sort
- * Pretty straight forward as this was heavily discussed in class
- * 
- * The number of phases is determined by n; the size of the array. 
- * But if array is sorted before n phases, exit early
- * 
- * @param arraySize: size of the array to be sorted. Used to determine stop case
- * @return void
- */ 
-void serialOddEven(int arraySize){
-    
-    bool swapped;
-
-    for (int phase = 0 ; phase < arraySize ; phase++){
-
-        swapped = false;
-
-        switch (phase % 2){
-
-            //even phase
-            case 0:
-                
-                for(int i = 0 ; i < arraySize ; i+=2){
-                    if ( array[i] > array[i+1] ){
-                        swap(i, i+1);
-                        swapped = true;
-                    }//if;
-                }//for
-
-                break;
-
-            //odd phase
-            case 1:
-
-                for(int i = 1 ; i < arraySize - 1 ; i+=2){
-                    if ( array[i] > array[i+1] ){
-                        swap(i, i+1);
-                        swapped = true;
-                    }//if;
-                }//for
-
-                break;
-
-        }//switch
-
-        if (swapped = false){
-            break;
-        }//if
-
-    }//for
-
-}//serialOddEven
-
-/**
- * Controller for the implementation of odd-even transposition sort.
- * Initialises a barrier for the threads, and creates all of them. Each thread
- * get the information it needs to find its chunk to sort
- * 
- * @param arraySize: size of the array to be sorted. Used to determine chunk size
- * @return void
- */ 
-void parallelOddEven(int arraySize){
-    
-    pthread_t* thread_handles;
-    int myLeft;
-    int chunk = arraySize/thread_count;
-    
-    thread_handles = malloc(thread_count * sizeof(pthread_t));
-    pthread_barrier_init(&barrier, NULL, thread_count);
-
-    for (int i = 0 ; i < thread_count ; i++){
-        thread_data *my_data = (thread_data *) malloc(sizeof(thread_data));
-        my_data->myStart = i * chunk;
-        my_data->myEnd = (my_data->myStart) + chunk;
-        my_data->arraySize = arraySize; 
-        pthread_create(&thread_handles[i], NULL, oddEvenStep, (void *) my_data);
-    }//for
-
-    for (int i = 0; i < thread_count; i++) {
-        pthread_join(thread_handles[i], NULL);
-    }//for
-
-    pthread_barrier_destroy(&barrier);
-
-}//parallelOddEven
-
-/**
- * Pthread Function
- * 
- * What every thread executes. This is where the sorting happens for the parallel implementation
- * 
- * Barriers are used to ensure all the threads enter the correct phase
- * at the same time. A global "global_swapped" boolean is used to exit the loop:
- * if none of the threads perform any swaps, then the array is sorted.
- * 
- * @param *arg: void pointer to the data the thread needs to begin its sort
- * @return void*
- */ 
-void* oddEvenStep(void *arg){
-    
-    int myStart = ((thread_data *) arg)->myStart;
-    int myEnd = ((thread_data *) arg)->myEnd;
-    int arraySize = ((thread_data *) arg)->arraySize;
-    bool swapped;
-    
-    //struct timeval stop, start, my_elapsed;
-    struct timespec start, finish;
-    double my_elapsed;
-
-    clock_gettime(CLOCK_MONOTONIC, &start);
-
-    while (global_swapped){
-
-        pthread_barrier_wait(&barrier);
-        swapped = false;
-        global_swapped = false;
-
-        for (int i = myStart ; i <= myEnd ; i += 2){
-
-            //even phase
-            if (array[i] > array[i + 1] ){
-                swap(i, i + 1);
-                swapped = true;
-            }//if
-
-        }//for
-
-        pthread_barrier_wait(&barrier);
-
-        //odd phase
-        for (int i = myStart + 1; i <= myEnd - 1; i += 2) {
-            
-            if ( i + 1 < arraySize && array[i] > array[i + 1] ){
-                swap(i, i + 1);
-                swapped = true;
-            }//if
-
-        }//for   
-
-        if (swapped && global_swapped == false){
-            pthread_mutex_lock(&mutex);
-            global_swapped = true;
-            pthread_mutex_unlock(&mutex);
-        }//if
-
-        pthread_barrier_wait(&barrier);
-
-    }//while
-
-    clock_gettime(CLOCK_MONOTONIC, &finish);
-
-    my_elapsed = (finish.tv_sec - start.tv_sec);
-    my_elapsed += (finish.tv_nsec - start.tv_nsec) / 1000000000.0;
-
-    pthread_mutex_lock(&mutex);
-    if (my_elapsed > elapsed){
-        elapsed = my_elapsed;
-    }//if
-    pthread_mutex_unlock(&mutex);
-    
-    pthread_exit(NULL);
-
-}//oddEvenStep
-
-/**
- * Swaps the two elements located at the provided indices of the array.
- * The array to be sorted is assumed to be of double precision numbers
- * 
- * @param array: pointer to the array of ints where the swap is to occur
- * @param x: first indice of array that needs to be swapped
- * @param y: second indice of array that needs to be swapped
- * @return void
- */  
-void swap(int x, int y) {
-   
-   int temp;
-   temp = array[x];
-   array[x] = array[y];
-   array[y] = temp;
-
-}//swap
-
-/**
- * Prints an array to stdout on a single line
- * 
- * Used in an eariler implementation
- * 
- * @param array: pointer to the array to print
- * @param size: the size of the array tp print
- * @return void
- */
-void printArray(int* array, int size){
-
-    for (int i = 0 ; i < size ; i++){
-        printf ("%d ", array[i]);
-    }//for
-
-    printf("\n");
-
-}//printArray
-
-/**
- * Displays how to use the program.
- * I saw that Peter Pacheco used a similar function for his programs,
- * so I thought I'd add one for mine
- * 
- * @param prog_name: name of the program
- * @return void
- */ 
-void Usage(const char* prog_name) {
-   fprintf(stderr, "usage:   %s <-s> <n> <t>\n", prog_name);
-   fprintf(stderr, "  's':  run serial odd-even transpostion sort\n");
-   fprintf(stderr, "   n:   number of elements in list\n");
-   fprintf(stderr, "   t:   number of threads to use\n");
-}//Usage
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Odd-Even Transposition Sort
+ * 
+ * oet_data.c
+ * 
+ * Serial and parallel data level implementation of odd-even transposition sort with PThreads
+ * 
+ * Generates an array of ints into memory based on the arguments from the command line. 
+ * Then odd-even transpostion sort is used to serially or parallely sort the array
+ * 
+ * The key type comes from sort_core.h and defaults to 32 bit ints. Compile with
+ * -DSORT_KEY=i64, u32, u64, f32 or f64 to sort a different type
+ * 
+ * Implementation is data level because the sorting threads have all the data in the array
+ * split up among them: there are no other task going on at the same time
+ * 
+ * The time to sort is recorded and printed to stdout
+ * 
+ * This implementation has more global variables than task level implementation.
+ * This should be changed, but it doesn't really matter for something this trivial
+ * 
+ * Methods:
+ *  - main(int argc, const char* argv[]) -> int
+ *      Creates a globally avaliable array and executes the sort serially
+ *      or paralelly based on args
+ *  
+ *  - serialOddEven(size_t arraySize) -> void
+ *      Serial implementation of odd-even transposition sort.
+ *      Operates on a globally avaliable array
+ * 
+ *  - parallelOddEven(size_t arraySize) -> void
+ *      Parallel implementation of odd-even transposition sort using Pthreads.
+ *      Operates on a globlly avaliable array, and gives each thread one chunk of it.
+ *      Any size works with any thread count: chunks differ in size by at most one,
+ *      and phases go on until nothing moves (thread_count phases aren't enough then)
+ * 
+ *  - oddEvenStep(int rank, void *arg) -> void
+ *      The work each thread in the parallel implementation must do.
+ *      Run as a job on the persistent worker pool (worker_pool.h).
+ *      Sorts its own chunk, then does phases of compare-split with the neighbouring
+ *      chunk until an even and an odd phase in a row exchange nothing
+ * 
+ *  - The phases, local sort, compare-split merges, swap and printArray
+ *      come from sort_core.h
+ * 
+ *  - Usage(const char* prog_name) -> void
+ *      Prints to stderr how to use the program (its calling format)
+ * 
+ * 
+ * Resources:
+ *  - https://github.com/Nalaka1693/pthread_odd_even_sort/blob/master/odd-even-sort.c
+ *      I found this guys implementation, which helped me structure my implementation quite
+ *      a bit. Especially for how the threads will work, I thought I'd be stuck with
+ *      array size / 2 threads (too much overhead)
+ * 
+ * Started November 13, 2019
+ * Completed November 14, 2019
+ * 
+ * Keegan Petreman (petreman@ualberta.ca)
+ * 1528679
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <time.h>
+#include <sys/time.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "worker_pool.h"
+#include "spin_barrier.h"
+
+#ifndef SORT_KEY
+#define SORT_KEY i32
+#endif
+#include "sort_core.h"
+#include "random_fill.h"
+
+//Constants
+#define MAX 1000 //set the upper bound for numbers generated
+
+//Function Prototypes
+void serialOddEven(size_t arraySize);
+void parallelOddEven(size_t arraySize);
+void oddEvenStep(int rank, void* arg);
+void Usage(const char* prog_name);
+
+//Global Variables
+int thread_count;
+elem_t* array;
+elem_t* scratch; //where each thread builds its half of a compare-split
+worker_pool pool; //sorting threads, created once in main
+spin_barrier barrier;
+pthread_mutex_t mutex;
+double elapsed = 0;
+
+//struct: data shared by the sorting threads, each finds its chunk from its rank
+typedef struct {
+    size_t arraySize;
+} thread_data;
+
+/**
+ * Preps the call to odd-even transpostion sort by first checking arguments,
+ * and generating an array based on what size was provided. Then execution is
+ * done serially or parallely based on args
+ * 
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given
+ * @return int
+ */ 
+int main(int argc, const char* argv[]){
+
+    size_t arraySize;
+    bool parallel = true;
+    uint64_t seed;
+    struct timespec stop, start;
+
+    //--seed can go anywhere, the rest are checked by position
+    argc = randomSeedOption(argc, argv, &seed);
+
+    //check arguments
+    switch (argc){
+
+        case 1:
+            arraySize = 8;
+            thread_count = 2;
+            break;
+
+        case 2:
+            
+            if (0 == strcmp(argv[1], "-s")){
+                parallel = false;
+                arraySize = 8;
+                thread_count = 1;
+            }//if
+
+            else{
+                //get size of array from command line
+                arraySize = strtoull(argv[1], NULL, 10);
+                thread_count = 2;
+            }//else
+
+            break;
+
+        case 3:
+            
+            if (0 == strcmp(argv[1], "-s")){
+                parallel = false;
+                arraySize = strtoull(argv[2], NULL, 10);
+                thread_count = 1;
+            }//if
+
+            else{
+                //get size of array from command line
+                arraySize = strtoull(argv[1], NULL, 10);
+                thread_count = strtol(argv[2], NULL, 10);
+            }//else
+
+            break;   
+
+        default:
+            Usage(argv[0]);
+            return EXIT_SUCCESS;   
+
+    }//switch
+
+    if (thread_count < 1){
+        Usage(argv[0]);
+        return EXIT_SUCCESS;
+    }//if
+
+    array = malloc(sizeof(elem_t) * arraySize);
+
+    if (array == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", arraySize);
+        return EXIT_FAILURE;
+    }//if
+
+    //threads are created once, they fill the array and then sort it
+    poolInit(&pool, thread_count);
+
+    //fill the array with random numbers between 0 and MAX, the same ones for the same seed
+    SORT(randomFill)(&pool, array, arraySize, MAX, seed);
+    printf("Seed %llu\n", (unsigned long long) seed);
+
+    if (parallel && thread_count > 1){
+        
+        parallelOddEven(arraySize);
+
+        printf("\nParallel time on array of size %zu (%d threads):\n"
+            "%f seconds\n", arraySize, 
+            thread_count, elapsed);
+
+    }//if
+
+    else{
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        serialOddEven(arraySize);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        elapsed = (stop.tv_sec - start.tv_sec);
+        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        printf("\nSerial time on array of size %zu:\n"
+            "%f seconds\n", arraySize, elapsed);
+
+    }//else
+
+    //checked outside the timing
+    if (!SORT(isSorted)(array, arraySize)){
+        fprintf(stderr, "The array didn't come out sorted\n");
+        return EXIT_FAILURE;
+    }//if
+
+    poolDestroy(&pool);
+    free(array); 
+
+    return EXIT_SUCCESS;
+
+}//main
+
+/**
+ * Serial implementation of odd-even transposition sort
+ * Pretty straight forward as this was heavily discussed in class
+ * 
+ * The number of phases is determined by n; the size of the array. 
+ * But if array is sorted before n phases, exit early
+ * 
+ * @param arraySize: size of the array to be sorted. Used to determine stop case
+ * @return void
+ */ 
+void serialOddEven(size_t arraySize){
+    
+    bool swapped;
+    bool lastSwapped = true;
+
+    if (arraySize < 2){
+        return;
+    }//if
+
+    for (size_t phase = 0 ; phase < arraySize ; phase++){
+
+        switch (phase % 2){
+
+            //even phase, pairs (0,1), (2,3)...
+            case 0:
+                swapped = SORT(compareExchange)(&array[0], arraySize / 2);
+                break;
+
+            //odd phase, pairs (1,2), (3,4)...
+            case 1:
+                swapped = SORT(compareExchange)(&array[1], (arraySize - 1) / 2);
+                break;
+
+        }//switch
+
+        //an even and an odd phase in a row without swaps means it's sorted
+        if (swapped == false && lastSwapped == false){
+            break;
+        }//if
+
+        lastSwapped = swapped;
+
+    }//for
+
+}//serialOddEven
+
+/**
+ * Controller for the implementation of odd-even transposition sort.
+ * Initialises a barrier for the threads, and hands the sort to the worker pool.
+ * Each thread gets the information it needs to find its chunk to sort
+ * 
+ * Instead of one element per compare/swap, every thread owns a whole chunk, so
+ * only about thread_count phases are needed rather than arraySize
+ * 
+ * @param arraySize: size of the array to be sorted. Used to determine chunk size
+ * @return void
+ */ 
+void parallelOddEven(size_t arraySize){
+    
+    thread_data my_data;
+    
+    scratch = malloc(sizeof(elem_t) * arraySize);
+
+    if (scratch == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the sort\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    spinBarrierInit(&barrier, thread_count);
+
+    my_data.arraySize = arraySize;
+    poolRun(&pool, oddEvenStep, (void *) &my_data);
+
+    spinBarrierDestroy(&barrier);
+    free(scratch);
+
+}//parallelOddEven
+
+/**
+ * Worker Pool Job
+ * 
+ * What every thread executes. This is where the sorting happens for the parallel implementation
+ * 
+ * Each thread first sorts its own chunk. Then in every phase, neighbouring threads
+ * (even/odd pairs on even phases, odd/even pairs on odd phases) do a compare-split:
+ * the lower thread keeps the smallest elements of both chunks and the upper
+ * thread keeps the largest, each as many as its own chunk holds. With equal chunks
+ * thread_count phases sort the whole array, but chunks that differ by one can need
+ * more (5 numbers on 4 threads, chunks of 2/1/1/1, reversed), so there is no fixed count
+ * 
+ * Barriers are used to ensure all the threads enter the correct phase
+ * at the same time, and that nobody overwrites a chunk its partner is still reading.
+ * The barrier also reduces each thread's exchange flag: once an even and an odd
+ * phase go by without any exchange, every boundary is in order (empty chunks are
+ * only ever at the end) and all threads stop
+ * 
+ * @param rank: rank of this thread in the pool, determines its chunk
+ * @param *arg: void pointer to the data the threads need to begin their sort
+ * @return void
+ */ 
+void oddEvenStep(int rank, void *arg){
+    
+    size_t arraySize = ((thread_data *) arg)->arraySize;
+    size_t myStart = chunkStart(rank, thread_count, arraySize);
+    size_t myEnd = chunkStart(rank + 1, thread_count, arraySize);
+    size_t chunk = myEnd - myStart;
+    size_t partnerStart, partnerEnd;
+    int partner;
+    bool exchange;
+    bool anyExchange;
+    bool lastAnyExchange = true;
+    
+    //struct timeval stop, start, my_elapsed;
+    struct timespec start, finish;
+    double my_elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    //local sort of this thread's chunk, its part of scratch is free until the first phase
+    SORT(mergeSort)(&array[myStart], &scratch[myStart], chunk);
+
+    spinBarrierWait(&barrier, rank);
+
+    for (int phase = 0 ; ; phase++){
+
+        //even phase pairs (0,1), (2,3)... odd phase pairs (1,2), (3,4)...
+        if (phase % 2 == rank % 2){
+            partner = rank + 1;
+        }//if
+
+        else{
+            partner = rank - 1;
+        }//else
+
+        exchange = false;
+
+        if (partner >= 0 && partner < thread_count){
+
+            partnerStart = chunkStart(partner, thread_count, arraySize);
+            partnerEnd = chunkStart(partner + 1, thread_count, arraySize);
+
+            //nothing to do if either chunk is empty or they are already in order
+            if (chunk == 0 || partnerEnd == partnerStart){
+                exchange = false;
+            }//if
+
+            else if (rank < partner){
+                exchange = array[myEnd - 1] > array[partnerStart];
+            }//else if
+
+            else{
+                exchange = array[partnerEnd - 1] > array[myStart];
+            }//else
+
+        }//if
+
+        if (exchange && rank < partner){
+            SORT(mergeLow)(&array[myStart], chunk,
+                &array[partnerStart], partnerEnd - partnerStart, &scratch[myStart]);
+        }//if
+
+        else if (exchange){
+            SORT(mergeHigh)(&array[myStart], chunk,
+                &array[partnerStart], partnerEnd - partnerStart, &scratch[myStart]);
+        }//else if
+
+        //partner must be done reading this chunk before it is overwritten
+        spinBarrierWait(&barrier, rank);
+
+        if (exchange){
+            memcpy(&array[myStart], &scratch[myStart], sizeof(elem_t) * chunk);
+        }//if
+
+        anyExchange = spinBarrierWaitOr(&barrier, rank, exchange);
+
+        //every thread sees the same result, so they all leave together
+        if (!anyExchange && !lastAnyExchange){
+            break;
+        }//if
+
+        lastAnyExchange = anyExchange;
+
+    }//for
+
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    my_elapsed = (finish.tv_sec - start.tv_sec);
+    my_elapsed += (finish.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    pthread_mutex_lock(&mutex);
+    if (my_elapsed > elapsed){
+        elapsed = my_elapsed;
+    }//if
+    pthread_mutex_unlock(&mutex);
+
+}//oddEvenStep
+
+/**
+ * Displays how to use the program.
+ * I saw that Peter Pacheco used a similar function for his programs,
+ * so I thought I'd add one for mine
+ * 
+ * @param prog_name: name of the program
+ * @return void
+ */ 
+void Usage(const char* prog_name) {
+   fprintf(stderr, "usage:   %s <-s> <n> <t> <--seed x>\n", prog_name);
+   fprintf(stderr, "  's':  run serial odd-even transpostion sort\n");
+   fprintf(stderr, "   n:   number of elements in list\n");
+   fprintf(stderr, "   t:   number of threads to use\n");
+   fprintf(stderr, "   x:   seed for the random numbers, the same seed sorts the same array\n");
+}//Usage
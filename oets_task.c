@@ -1,769 +1,866 @@
-/**
- * AUCSC 310/450
- * Combined Term Project
- * Odd-Even Transposition Sort
- * 
- * oets_task.c
- * 
- * Implementation of odd-even transposition sort with Pthreads
- * Reads in 8 files of 100000 doubles each, and sorts them using odd-even transposition
- * 
- * Implementation is task level parallelism; even though the sorting threads have 
- * all the data in the array split up among them, other tasks are happening in the background to 
- * ensure the final result is calculated as quickly as possible (threads reading in more files 
- * and merging sorted files while other threads sort)
- * 
- * The time to sort is recorded and printed to stdout
- * 
- * Methods:
- *  - main(int argc, const char* argv[]) -> int
- *      Creates or opens the files needed, then calls odd-even sort serially
- *      or paralelly based on args
- * 
- *  - serialOddEven(double* array, int size) -> void
- *      Serial implementation of odd-even transposition sort
- *      Operates by first reading in all files into memory, then sorting with one thread
- * 
- *  - parallelOddEven(double* array) -> void
- *      Parallel implementation of odd-even transposition sort using Pthreads.
- *      Takes in the specified number of files of double numbers, and sorts them
- *      by having the user specified number of threads sort ach file, while 
- *      another 2 threads read in the next file and two sorted files if possible
- * 
- *  - openFiles() -> void
- *      Opens or creates all the files of doubles to be sorted
- * 
- *  - swap(double* array, int x, int y) -> void
- *      Swaps the elements at indices x and y in the provided array of doubles
- * 
- *  - readIn(void* rank) -> void*
- *      Pthread function
- *      Reads a file into memory
- * 
- *  - oddEvenStep(void *arg) -> void*
- *      Pthread function
- *      The work each sorting thread in the parallel implementation does
- * 
- *  - merge(void *args) -> void*
- *      Pthread function
- *      Merges two sorted subarrays
- * 
- *  - writeResult(double* array, const char* fileName) -> void
- *      Writes an array to file.
- *      Intended to be used after all files merged and sorted to get final result
- *  
- *  - startFetchThread(pthread_t* thread, int j) -> void
- *      Starts the fetch thread with its needed arguments to read in a file
- * 
- *  - startMergeThread(pthread_t *thread, int j) -> void
- *      Starts the merge with its needed arguments to merge two sorted subarrays
- * 
- *  - printArray(int* array, int size) -> void
- *      Prints an array on a single line to stdout
- * 
- *  - Usage(const char* prog_name) -> void
- *      Prints to stderr how to use the program
- * 
- * Resources:
- *  - https://github.com/Nalaka1693/pthread_odd_even_sort/blob/master/odd-even-sort.c
- *      I found this guys implementation, which helped me structure my implementation quite
- *      a bit. Especially for how the threads will work, I thought I'd be stuck with
- *      array size / 2 threads (too much overhead)
- *  
- *  - https://www.geeksforgeeks.org/merge-sort/
- *      Followed their algorithm for merging two sorted subarrays
- * 
- * Started November 13, 2019
- * Completed November 24, 2019
- * 
- * Keegan Petreman (petreman@ualberta.ca)
- * 1528679
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <float.h>
-#include <time.h>
-#include <sys/time.h>
-#include <stdbool.h>
-#include <string.h>
-#include <pthread.h>
-
-//Constants
-#define MAX 100000 //upper bound on the numbers generated
-#define TOTAL_FILES 8 //how many files to sort
-#define NUMS_PER_FILE 100000 //how many numbers in each file
-
-//Function Prototypes
-void serialOddEven(double* array, int size);
-void parallelOddEven(double* array);
-void openFiles();
-void swap(double* array, int x, int y);
-void* readIn(void* rank);
-void* oddEvenStep(void *arg);
-void* merge(void *args);
-void writeResult(double* array, const char* fileName);
-void startFetchThread(pthread_t* thread, double* array, int j);
-void startMergeThread(pthread_t *thread, double* array, int j);
-void printArray(double* array, int size);
-void Usage(const char* prog_name);
-
-//Global Variables
-int thread_count;
-FILE *fps[TOTAL_FILES];
-pthread_barrier_t barrier;
-pthread_mutex_t mutex;
-bool global_swapped;
-
-//Structs
-//data for the fetch thread
-typedef struct {
-    double* array;
-    int rank;
-} fetch_thread_data;
-
-//data for each sorting thread
-typedef struct {
-    double* array;
-    int myStart;
-    int myEnd;
-    int endOfFile;
-} sort_thread_data;
-
-//data for the merging thread
-typedef struct {
-    double* array;
-    int left;
-    int mid;
-    int right;
-} merge_thread_data;
-
-/**
- * Preps the call to odd-even transpostion sort by checking the arguments for serial 
- * or parallel execution, as well as generating the necessary files of data if they 
- * don't exist
- * 
- * @param argc: number of arguments given
- * @param argv[]: the arguments given
- * @return int
- */ 
-int main(int argc, const char* argv[]){
-
-    double* array;
-    double elapsed;
-    int arraySize = TOTAL_FILES * NUMS_PER_FILE;
-    bool parallel = true;
-    struct timespec stop, start;
-
-    //check arguments
-    switch (argc){
-
-        case 1:
-            thread_count = 2;
-            break;
-
-        case 2:
-            
-            if (0 == strcmp(argv[1], "-s")){
-                parallel = false;
-                thread_count = 1;
-            }//if
-
-            else{
-                //get number of threads
-                thread_count = strtol(argv[1], NULL, 10);
-            }//else
-
-            break;
-
-        default:
-            Usage(argv[0]);
-            return EXIT_SUCCESS;   
-
-    }//switch
-
-    if (NUMS_PER_FILE % thread_count != 0){
-        fprintf(stderr, "Please only use thread counts that" 
-        "can easily divide the total numbers per file (%d)\n", NUMS_PER_FILE);
-        return EXIT_SUCCESS;
-    }//if
-
-    srand((unsigned) time(NULL));
-
-    //open/create the files
-    openFiles();
-    
-    //allocate space in memory for numbers to be brought in
-    array = malloc(sizeof(double) * arraySize);
-    
-    //parallel odd-even
-    if (parallel && thread_count > 1){
-        
-        clock_gettime(CLOCK_MONOTONIC, &start);
-        parallelOddEven(array);
-        clock_gettime(CLOCK_MONOTONIC, &stop);
-
-        elapsed = (stop.tv_sec - start.tv_sec);
-        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
-
-        printf("\nParallel time to sort %d files with %d numbers each (%d threads):\n"
-            "%f seconds\n", TOTAL_FILES, NUMS_PER_FILE, thread_count, elapsed);
-
-    }//if
-
-    //serial odd-even
-    else{
-        
-        clock_gettime(CLOCK_MONOTONIC, &start);
-        serialOddEven(array, arraySize);
-        clock_gettime(CLOCK_MONOTONIC, &stop);
-
-        elapsed = (stop.tv_sec - start.tv_sec);
-        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
-
-        printf("\nSerial time to sort %d files with %d numbers each:\n"
-            "%f seconds\n", TOTAL_FILES, NUMS_PER_FILE, elapsed);
-
-    }//else
-
-    free(array); 
-
-    for (int i = 0 ; i < TOTAL_FILES ; i++){
-        fclose(fps[i]);
-    }//for
-
-    return EXIT_SUCCESS;
-
-}//main
-
-/**
- * Serial implementation of odd-even transposition sort
- * A single thread reads the contents of all the files into memory, and the same
- * thread then sorts the combined files with odd-even transposition sort serially
- * 
- * Results of the sort are then written to a file
- * 
- * @param array: pointer to the array of doubles to be sorted
- * @param arraySize: size of the array to be sorted. Used to determine stop case
- * @return void
- */ 
-void serialOddEven(double* array, int arraySize){
-    
-    bool swapped;
-
-    //read in all the files at once into array in memory
-    for (int i = 0 ; i < TOTAL_FILES ; i++){
-        
-        for (int j = 0 ; j < NUMS_PER_FILE ; j++){
-            fscanf(fps[i], "%lf", &array[i * NUMS_PER_FILE + j]);
-        }//for
-        
-    }//for
-
-    for (int phase = 0 ; phase < arraySize ; phase++){
-
-        swapped = false;
-
-        switch (phase % 2){
-
-            //even phase
-            case 0:
-                
-                for(int i = 0 ; i < arraySize ; i+=2){
-                    if ( array[i] > array[i+1] ){
-                        swap(array, i, i+1);
-                        swapped = true;
-                    }//if;
-                }//for
-
-                break;
-
-            //odd phase
-            case 1:
-
-                for(int i = 1 ; i < arraySize - 1 ; i+=2){
-                    if ( array[i] > array[i+1] ){
-                        swap(array, i, i+1);
-                        swapped = true;
-                    }//if;
-                }//for
-
-                break;
-
-        }//switch
-
-        if (swapped == false){
-            break;
-        }//if
-
-    }//for
-
-    //write back the result
-    writeResult(array, "serialOetsResult.txt");
-
-}//serialOddEven
-
-/**
- * Controller for the implementation of parallel odd-even ransposition sort.
- * Initialises a barrier for the sorting threads, and creates all of them. Each thread
- * get the information it needs to find its even and odd pair for every step.
- * 
- * Number of threads to be sorting is specified by the user
- * One thread reads in the files, and another merges two sorted subarrays
- * 
- * After execution finishes, the results are written to a file
- * 
- * @param array: pointer to the array of doubles to be sorted
- * @return void
- */ 
-void parallelOddEven(double* array){
-    
-    pthread_t* thread_handles;
-    pthread_t fetch_thread, merge_thread;
-    int fileStart;
-    int chunk = NUMS_PER_FILE/thread_count; //how many numbers for each thread to sort
-    
-    //allocate the sorting threads, total specified by user
-    thread_handles = malloc(thread_count * sizeof(pthread_t));
-
-    pthread_barrier_init(&barrier, NULL, thread_count);
-
-    //need to read in first file to begin sorting and wait for it 
-    //to join to make sure that there is correct data to sort
-    startFetchThread(&fetch_thread, array, 0);
-    pthread_join(fetch_thread, NULL);
-
-    //loop to get every file
-    for (int j = 0 ; j < TOTAL_FILES ; j++){
-
-        //get beginning index in array for current file
-        fileStart = (j * NUMS_PER_FILE);
-
-        //make sure next read in is finished before calling sort
-        if (j > 0){
-            pthread_join(fetch_thread, NULL);
-        }//else
-        
-        //start sorting file
-        //
-        //I could and should of put everything in here into a function, but then 
-        //i, chunk, and fileStart would all have to be passed as parameters
-        for (int i = 0 ; i < thread_count ; i++){
-            
-            sort_thread_data *my_sort_data = 
-                (sort_thread_data *) malloc(sizeof(sort_thread_data));
-
-            if (my_sort_data == NULL) {
-                fprintf(stderr, "Couldn't allocate memory for thread arg\n");
-                exit(EXIT_FAILURE);
-            }//if
-
-            my_sort_data->array = array;
-            my_sort_data->myStart = (i * chunk) + fileStart;
-            my_sort_data->myEnd = (my_sort_data->myStart) + chunk;
-            my_sort_data->endOfFile = fileStart + (NUMS_PER_FILE - 1);
-            pthread_create(&thread_handles[i], NULL, oddEvenStep, (void *) my_sort_data);
-
-        }//for
-
-        //join merge_thread before calling it again below
-        if (j > 2){
-            pthread_join(merge_thread, NULL);
-        }//if
-        
-        //if 2 or more files have been brought in and sorted, merge them
-        if (j > 1){
-            startMergeThread(&merge_thread, array, j);
-        }//if
-
-        //read in the next file while previous is sorting
-        if (j+1 < TOTAL_FILES){
-            startFetchThread(&fetch_thread, array, j + 1);
-        }//if
-
-        //if no more files, join the fetch thread
-        else{
-            pthread_join(fetch_thread, NULL);
-        }//else
-        
-        //join the sorting threads
-        for (int i = 0; i < thread_count; i++) {
-            pthread_join(thread_handles[i], NULL);
-        }//for
-
-    }//for   
-
-    //Have to join the merge thread before calling it again to merge in the last file
-    pthread_join(merge_thread, NULL);
-    startMergeThread(&merge_thread, array, TOTAL_FILES);
-    pthread_join(merge_thread, NULL);
-
-    //after last merge finished, write result of sort to file
-    writeResult(array, "paralllelOetsResult.txt");
-
-    //cleanup
-    free(thread_handles);
-    pthread_barrier_destroy(&barrier);
-
-}//parallelOddEven
-
-/**
- * Opens or creates all the files of doubles to be sorted.
- * Their file pointers are stored in a globally accessible array
- * 
- * @return void
- */ 
-void openFiles(){
-
-    char filename[10];
-
-    for (int i = 0 ; i < TOTAL_FILES ; i++){
-
-        sprintf(filename, "data%d.txt", i+1);
-
-        fps[i] = fopen(filename, "ab+");
-        
-        if (fps[0] == NULL){ 
-            perror("Error"); 
-            exit(EXIT_FAILURE);
-        }//if
-
-        /*
-         * Check if each file is empty or not.
-         * If it is, generates NUMS_PER_FILE random doubles 
-         * for the file. Otherwise nothing happens 
-         * (assumed it has correct amount of random doubles already)
-         */ 
-
-        // goto end of file
-        if (fseek(fps[i], 0, SEEK_END) != 0){
-            perror("Error"); 
-            exit(EXIT_FAILURE);
-        }//if
-        
-        //if seek to end didn't move pointer, file is empty
-        if (ftell(fps[i]) == 0){
-            
-            printf("Filling file data%d.txt...\n", (i+1) );
-            
-            //fill file with doubles with range 0 to MAX
-            for (int j = 0 ; j < NUMS_PER_FILE ; j++){
-                fprintf(fps[i], "%lf ", 
-                    (double)rand() / (double)(RAND_MAX / MAX));
-            }//for
-
-        }//if
-
-        //go back to beginning of file
-        fseek(fps[i], 0, SEEK_SET);
-
-    }//for
-
-}//openFiles
-
-/**
- * Swaps the two elements located at the provided indices of the array.
- * The array to be sorted is assumed to be of double precision numbers
- * 
- * @param array: pointer to the array of doubles where the swap is to occur
- * @param x: first indice of array that needs to be swapped
- * @param y: second indice of array that needs to be swapped
- * @return void
- */ 
-void swap(double* array, int x, int y) {
-   
-   double temp;
-   temp = array[x];
-   array[x] = array[y];
-   array[y] = temp;
-
-}//swap
-
-/**
- * Pthread Function
- * 
- * Reads a file into the array so it may be sorted afterwards in memory
- * 
- * @param *arg: pointer to the data the thread needs to read the file in
- * @return void*
- */ 
-void* readIn(void *arg){
-    
-    double* array = ((fetch_thread_data *) arg)->array;
-    int my_rank = ((fetch_thread_data *) arg)->rank;
-    int offsetForFile = my_rank * NUMS_PER_FILE;
-
-    free(arg);
-
-    for (int offsetWithinFile = 0 ; offsetWithinFile < NUMS_PER_FILE ; offsetWithinFile++){
-        fscanf(fps[my_rank], "%lf", &array[offsetForFile + offsetWithinFile]);
-    }//for
-
-    pthread_exit(NULL);
-
-}//readIn
-
-/**
- * Pthread Function
- * 
- * What every sorting thread executes. This is where the sorting happens for the parallel implementation
- * 
- * Barriers are used to ensure all the threads enter the correct phase
- * at the same time. A global "global_swapped" boolean is used to exit the loop:
- * if none of the threads perform any swaps, then the array is sorted.
- * 
- * @param *arg: pointer to the data the thread needs to begin its sort
- * @return void*
- */ 
-void* oddEvenStep(void *arg){
-    
-    bool swapped; //local swap variable
-    double* array = ((sort_thread_data *) arg)-> array;
-    int myStart = ((sort_thread_data *) arg)->myStart;
-    int myEnd = ((sort_thread_data *) arg)->myEnd;
-    int endOfFile = ((sort_thread_data *) arg)->endOfFile;
-
-    free(arg);
-
-    //sort while globally (across all threads) is a swap that happens
-    do {
-
-        pthread_barrier_wait(&barrier);
-        swapped = false;
-        global_swapped = false;
-
-        //even phase
-        for (int i = myStart ; i <= myEnd ; i += 2){
-
-            if (i + 1 <= endOfFile && array[i] > array[i + 1] ){
-                swap(array, i, i + 1);
-                swapped = true;
-            }//if
-
-        }//for
-
-        pthread_barrier_wait(&barrier);
-
-        //odd phase
-        for (int i = myStart + 1; i <= myEnd - 1; i += 2) {
-            
-            if ( i + 1 < endOfFile && array[i] > array[i + 1] ){
-                swap(array, i, i + 1);
-                swapped = true;
-            }//if
-
-        }//for   
-
-        if (swapped && (global_swapped == false)){
-            pthread_mutex_lock(&mutex);
-            global_swapped = true;
-            pthread_mutex_unlock(&mutex);
-        }//if
-
-        pthread_barrier_wait(&barrier);
-
-    } while (global_swapped);
-    
-    pthread_exit(NULL);
-
-}//oddEvenStep
-
-/**
- * Pthread function
- * 
- * Takes a pointer to an array of doubles where the subarrays 0 to mid is and mid+1 
- * to end is sorted, and combines them into one whole sorted array.
- * 
- * Adapted from my merge sort implementation from 310 
- * (which itself was taken from https://www.geeksforgeeks.org/merge-sort/)
- * 
- * @param *args: pointer to the struct of data the thread needs to merge
- * @return void*: pthread function
- */ 
-void* merge(void *arg){
-
-    //get args
-    double* array = ((merge_thread_data *) arg)->array;
-    int left = ((merge_thread_data *) arg)->left;
-    int mid = ((merge_thread_data *) arg)->mid;
-    int right = ((merge_thread_data *) arg)->right;    
-
-    free(arg);
-
-    int i, j, k; 
-    int n1 = mid - left + 1; 
-    int n2 =  right - mid; 
-  
-    //create temp arrays
-    double* L = malloc(sizeof(double) * n1);
-    double* R = malloc(sizeof(double) * n2);
-
-    //Copy data to temp arrays L[] and R[]
-    for (i = 0; i < n1; i++){
-        L[i] = array[left + i];
-    }//for 
-         
-    for (j = 0; j < n2; j++){
-        R[j] = array[mid + 1 + j];
-    }//for 
-         
-    //Merge the temp arrays back into arr[l..r]
-    i = 0; // Initial index of first subarray 
-    j = 0; // Initial index of second subarray 
-    k = left; // Initial index of merged subarray 
-
-    while (i < n1 && j < n2) { 
-        
-        if (L[i] < R[j]) { 
-            array[k] = L[i]; 
-            i++; 
-        }//if 
-
-        else { 
-            array[k] = R[j]; 
-            j++; 
-        }//else
-
-        k++; 
-
-    }//while 
-  
-    //Copy the remaining elements of L[], if there are any
-    while (i < n1) { 
-        array[k] = L[i]; 
-        i++; 
-        k++; 
-    }//while 
-  
-    //Copy the remaining elements of R[], if there are any
-    while (j < n2) { 
-        array[k] = R[j]; 
-        j++; 
-        k++; 
-    }//while 
-
-    free(L);
-    free(R);
-
-    pthread_exit(NULL);
-
-}//merge
-
-/**
- * Writes the provided array of doubles to the provided file
- * Amount of numbers to be written is based on how many were in the source file
- * 
- * @param array: pointer to the array to be written
- * @param filename: name of the file the array will be written to
- * @return void
- */ 
-void writeResult(double* array, const char* filename){
-    
-    //create/truncate file to store results
-    FILE *fp = fopen(filename, "w+");
-
-    //fopen returns the NULL pointer on failure
-    if (fp == NULL){ 
-        perror("Error"); 
-        exit(EXIT_FAILURE);
-    }//if 
-
-    //write back to new file
-    for (int i = 0 ; i < TOTAL_FILES ; i++){
-
-        int k = i * NUMS_PER_FILE;
-        
-        for (int j = 0 ; j < NUMS_PER_FILE ; j++){
-            fprintf(fp, "%lf ", array[k + j]);
-        }//for
-        
-    }//for
-
-    fclose(fp);
-
-}//writeResult
-
-/**
- * Starts the thread responsible for bringing files into memory.
- * File to bring in is determined by rank
- * 
- * @param *thread: address of the thread to bring file into memory
- * @param array: the array to store the fetch to
- * @param rank: rank of the file to bring in (index into fps)
- * @return void
- */ 
-void startFetchThread(pthread_t *thread, double* array, int rank){
-
-    fetch_thread_data *fetch_data = 
-        (fetch_thread_data *) malloc(sizeof(fetch_thread_data));
-            
-    if (fetch_data == NULL) {
-        fprintf(stderr, "Couldn't allocate memory for thread arg\n");
-        exit(EXIT_FAILURE);
-    }//if
-
-    fetch_data->array = array;
-    fetch_data->rank = rank; 
-
-    pthread_create(thread, NULL, readIn, (void*) fetch_data);
-
-}//startFetchThread
-
-/**
- * Starts the thread responsible for merging the sorted files j and j-1
- * 
- * @param *thread: address of the thread to do the merge
- * @param array: the array with the subarrays to merge
- * @param j: used to determine which files to merge (indexes into fps)
- * @return void
- */ 
-void startMergeThread(pthread_t *thread, double* array, int j){
-    
-    merge_thread_data *merge_data = 
-        (merge_thread_data *) malloc(sizeof(merge_thread_data));
-
-    if (merge_data == NULL) {
-        fprintf(stderr, "Couldn't allocate memory for thread arg\n");
-        exit(EXIT_FAILURE);
-    }//if
-
-    merge_data->array = array;
-    merge_data->left = 0;
-    merge_data->mid = ( (j-1) * NUMS_PER_FILE ) - 1;
-    merge_data->right = (j * NUMS_PER_FILE) - 1;    
-    pthread_create(thread, NULL, merge, (void *) merge_data);
-
-}//startMergeThread
-
-/**
- * Prints an array to stdout on a single line
- * 
- * Used in an eariler implementation
- * 
- * @param array: pointer to the array to print
- * @param size: the size of the array tp print
- * @return void
- */
-void printArray(double* array, int size){
-
-    for (int i = 0 ; i < size ; i++){
-        printf ("%lf ", array[i]);
-    }//for
-
-    printf("\n");
-
-}//printArray
-
-/**
- * Displays how to use the program.
- * I saw that Peter Pacheco used a similar function for his programs,
- * so I thought I'd add one for mine
- * 
- * @param prog_name: name of the program
- * @return void
- */ 
-void Usage(const char* prog_name) {
-   fprintf(stderr, "usage:   %s <-s/t>\n", prog_name);
-   fprintf(stderr, "  's':  run serial odd-even transpostion sort\n");
-   fprintf(stderr, "   t:   run parallel odd-even transpostion sort with t threads\n");
-}//Usage
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Odd-Even Transposition Sort
+ * 
+ * oets_task.c
+ * 
+ * Implementation of odd-even transposition sort with Pthreads
+ * Reads in the files named on the command line (or every file in the directories
+ * named), and sorts them using odd-even transposition. The files can hold any number
+ * of numbers each; the array is made for their real total. With no files named,
+ * data1 ... data8 with 100000 doubles each are used (and made if they don't exist)
+ * 
+ * The key type comes from sort_core.h and defaults to doubles. Compile with
+ * -DSORT_KEY=i32, i64, u32, u64 or f32 to sort the numbers as a different type
+ * 
+ * Implementation is task level parallelism: reading a file in, sorting it and merging
+ * the sorted files are tasks of a task graph (task_graph.h) run by a work-stealing
+ * pool of threads. The files are cut into blocks of a fixed number of numbers (--block,
+ * 65536 by default, never more than an even share per thread) and each block is
+ * sorted by one thread as soon as it is in (reader threads bring the files in, many
+ * reads at a time: async_read.h), so the front of a huge file is being sorted while
+ * the rest is still coming in, different files are read and sorted at the same time,
+ * and nothing waits for a block it doesn't need
+ * 
+ * Numbers on standard input ("-" as the only file) are sorted the same way as they
+ * come down the pipe: every block is handed to the threads as soon as it is parsed,
+ * so sorting what is in hides behind waiting for the rest
+ * 
+ * Once every block is sorted they are combined with a parallel merge (parallel_merge.h):
+ * the output is split into one equal segment per thread by co-ranking the sorted
+ * blocks, and every thread merges its own segment, so no single thread has to merge
+ * the whole output. The merge is done in place, with the blocks it has read from
+ * recycled for its output, so it needs little memory beyond the numbers themselves
+ * 
+ * With --memory MB the files are sorted externally instead (external_sort.h): only
+ * that much memory holds numbers at once, sorted runs go to disk and are merged
+ * back, so the files can be much bigger than memory. Text files are parsed into
+ * the runs as they're needed then, instead of all at once when they are opened
+ * 
+ * The time to sort is recorded and printed to stdout
+ * 
+ * Methods:
+ *  - main(int argc, const char* argv[]) -> int
+ *      Creates or opens the files needed, then calls odd-even sort serially
+ *      or paralelly based on args
+ * 
+ *  - serialOddEven(elem_t* array, size_t size) -> void
+ *      Serial implementation of odd-even transposition sort
+ *      Operates by first reading in all files into memory, then sorting with one thread
+ * 
+ *  - parallelOddEven(elem_t* array) -> void
+ *      Parallel implementation of odd-even transposition sort using Pthreads.
+ *      Takes in the files of double numbers, and sorts them on a pool of the
+ *      user specified number of threads, each file by whichever thread is free once
+ *      the reader threads have brought it in (see async_read.h). The sorted files are
+ *      then combined by the same threads with a parallel merge, in place in array
+ * 
+ *  - runPipeline(void* arg) -> void
+ *      Task function
+ *      Builds the task graph of reading, sorting and merging, and runs it
+ * 
+ *  - streamOddEven() -> size_t
+ *      Parallel odd-even transposition sort of standard input, each block sorted
+ *      as soon as it has come in and been parsed. Returns how many numbers there were
+ * 
+ *  - runStream(void* arg) -> void
+ *      Task function
+ *      Parses standard input a block at a time, hands each block to the threads,
+ *      then merges the blocks once the input has ended
+ * 
+ *  - sortBlock(void* arg) -> void
+ *      Task function
+ *      Sorts one block on whichever thread gets to it: with odd-even transposition
+ *      if it is short, with introsort (sort_core.h) otherwise
+ * 
+ *  - oddEvenSort(elem_t* array, size_t size) -> void
+ *      Odd-even transposition sort on one thread, until a pair of phases swaps nothing
+ * 
+ *  - externalSortFiles() -> size_t
+ *      Sorts the files within the memory budget, through runs on disk. Returns
+ *      how many numbers there were
+ * 
+ *  - openFiles(int count, const char* paths[]) -> void
+ *      Opens the files (or directories of files) given, or opens or creates the
+ *      default ones (binary, memory-mapped), and works out where each one goes
+ * 
+ *  - closeFiles() -> void
+ *      Closes every file
+ * 
+ *  - writeResult(elem_t* array, size_t size, const char* fileName) -> void
+ *      Writes an array to file.
+ *      Intended to be used after all files merged and sorted to get final result
+ *  
+ *  - The merge's nodes come from parallel_merge.h, externalSort from external_sort.h,
+ *    the file prefetching from async_read.h and the task graph from task_graph.h
+ * 
+ *  - The phases, merging two runs, swap and printArray come from sort_core.h
+ * 
+ *  - Usage(const char* prog_name) -> void
+ *      Prints to stderr how to use the program
+ * 
+ * Resources:
+ *  - https://github.com/Nalaka1693/pthread_odd_even_sort/blob/master/odd-even-sort.c
+ *      I found this guys implementation, which helped me structure my implementation quite
+ *      a bit. Especially for how the threads will work, I thought I'd be stuck with
+ *      array size / 2 threads (too much overhead)
+ *  
+ *  - https://www.geeksforgeeks.org/merge-sort/
+ *      Followed their algorithm for merging two sorted subarrays
+ * 
+ * Started November 13, 2019
+ * Completed November 24, 2019
+ * 
+ * Keegan Petreman (petreman@ualberta.ca)
+ * 1528679
+*/
+
+#define _GNU_SOURCE //mremap
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <time.h>
+#include <sys/time.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "worker_pool.h"
+#include "task_pool.h"
+#include "task_graph.h"
+
+#ifndef SORT_KEY
+#define SORT_KEY f64
+#endif
+#include "sort_core.h"
+#include "data_files.h"
+#include "parallel_merge.h"
+#include "external_sort.h"
+#include "async_read.h"
+
+//Constants
+#define MAX 100000 //upper bound on the numbers generated
+#define DEFAULT_FILES 8 //how many files to sort when none are named
+#define DEFAULT_NUMS_PER_FILE 100000 //how many numbers each of those needs
+#define STREAM_START_BYTES (16 << 20) //first mapping for standard input, doubled as it fills
+#define ODD_EVEN_CUTOFF 1024 //blocks this short are sorted with odd-even, longer ones with introsort
+
+//Function Prototypes
+void serialOddEven(elem_t* array, size_t size);
+void parallelOddEven(elem_t* array);
+size_t externalSortFiles();
+void openFiles(int count, const char* paths[]);
+void closeFiles();
+void runPipeline(void* arg);
+size_t streamOddEven();
+void runStream(void* arg);
+void sortBlock(void* arg);
+void oddEvenSort(elem_t* array, size_t size);
+void writeResult(elem_t* array, size_t size, const char* fileName);
+void Usage(const char* prog_name);
+
+//Global Variables
+int thread_count;
+uint64_t seed; //for making data files that don't exist
+size_t memoryBudget; //bytes of numbers held at once when sorting externally, 0 if not
+int readDepth; //reads of the files each reader keeps in flight ahead of the sort
+int readerCount; //threads reading the files in
+size_t blockSize; //numbers sorted as one piece, 0 for whole files
+int totalFiles;
+data_file* files;
+size_t* fileStarts; //file i goes in [fileStarts[i], fileStarts[i + 1]) of the array
+
+//Structs
+//one block for a sorting task
+typedef struct {
+    elem_t* array;
+    size_t blockStart;
+    size_t blockLength;
+} sort_block_data;
+
+//what the whole parallel sort needs, for the task that runs it
+typedef struct {
+    task_pool* tasks;
+    elem_t* array;
+} pipeline_data;
+
+//the same for sorting standard input, where nothing is known until it ends
+typedef struct {
+    task_pool* tasks;
+    elem_t* array; //mapped, and grown with mremap as the numbers come
+    size_t reserved; //bytes mapped
+    size_t* starts; //where each block starts, one more than there are blocks
+    size_t total;
+} stream_data;
+
+/**
+ * Preps the call to odd-even transpostion sort by checking the arguments for serial 
+ * or parallel execution, as well as generating the necessary files of data if they 
+ * don't exist
+ * 
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given
+ * @return int
+ */ 
+int main(int argc, const char* argv[]){
+
+    elem_t* array;
+    double elapsed;
+    size_t arraySize;
+    int inputs; //files or directories named
+    bool parallel = true;
+    bool streaming; //standard input, sorted as it comes in
+    struct timespec stop, start;
+
+    //--seed can go anywhere, the rest are checked by position
+    argc = randomSeedOption(argc, argv, &seed);
+    argc = externalMemoryOption(argc, argv, &memoryBudget);
+    argc = asyncReadOptions(argc, argv, &readDepth, &readerCount, &blockSize);
+
+    //check arguments, anything after the first one is a file or directory to sort
+    if (argc == 1){
+        thread_count = 2;
+    }//if
+
+    else if (0 == strcmp(argv[1], "-s")){
+        parallel = false;
+        thread_count = 1;
+    }//else if
+
+    else{
+        //get number of threads
+        thread_count = strtol(argv[1], NULL, 10);
+    }//else
+
+    if (thread_count < 1){
+        Usage(argv[0]);
+        return EXIT_SUCCESS;
+    }//if
+
+    inputs = (argc > 2) ? argc - 2 : 0;
+    streaming = parallel && thread_count > 1 && memoryBudget == 0 && inputs == 1
+        && strcmp(argv[argc - 1], DATA_STDIN) == 0;
+
+    //parsed and sorted as it comes, so there are no files to open first
+    if (streaming){
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        arraySize = streamOddEven();
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        elapsed = (stop.tv_sec - start.tv_sec);
+        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        printf("\nParallel time to sort standard input with %zu numbers (%d threads):\n"
+            "%f seconds\n", arraySize, thread_count, elapsed);
+
+        return EXIT_SUCCESS;
+
+    }//if
+
+    //open/create the files
+    openFiles(inputs, &argv[argc - inputs]);
+    arraySize = fileStarts[totalFiles];
+
+    //out of memory sort, the whole array is never allocated
+    if (memoryBudget > 0){
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        //text files are only counted as they are read
+        arraySize = externalSortFiles();
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        elapsed = (stop.tv_sec - start.tv_sec);
+        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        printf("\nExternal time to sort %d files with %zu numbers in all (%d threads, %zu MB):\n"
+            "%f seconds\n", totalFiles, arraySize, thread_count, memoryBudget >> 20, elapsed);
+
+        closeFiles();
+        return EXIT_SUCCESS;
+
+    }//if
+    
+    //allocate space in memory for numbers to be brought in (+1 so it's never 0 bytes)
+    array = malloc(sizeof(elem_t) * (arraySize + 1));
+
+    if (array == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", arraySize);
+        return EXIT_FAILURE;
+    }//if
+    
+    //parallel odd-even
+    if (parallel && thread_count > 1){
+        
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        parallelOddEven(array);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        elapsed = (stop.tv_sec - start.tv_sec);
+        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        printf("\nParallel time to sort %d files with %zu numbers in all (%d threads):\n"
+            "%f seconds\n", totalFiles, arraySize, thread_count, elapsed);
+
+    }//if
+
+    //serial odd-even
+    else{
+        
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        serialOddEven(array, arraySize);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        elapsed = (stop.tv_sec - start.tv_sec);
+        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        printf("\nSerial time to sort %d files with %zu numbers in all:\n"
+            "%f seconds\n", totalFiles, arraySize, elapsed);
+
+    }//else
+
+    free(array); 
+    closeFiles();
+
+    return EXIT_SUCCESS;
+
+}//main
+
+/**
+ * Serial implementation of odd-even transposition sort
+ * A single thread reads the contents of all the files into memory, and the same
+ * thread then sorts the combined files with odd-even transposition sort serially
+ * 
+ * Results of the sort are then written to a file
+ * 
+ * @param array: pointer to the array of doubles to be sorted
+ * @param arraySize: size of the array to be sorted. Used to determine stop case
+ * @return void
+ */ 
+void serialOddEven(elem_t* array, size_t arraySize){
+
+    //read in all the files at once into array in memory
+    for (int i = 0 ; i < totalFiles ; i++){
+        SORT(dataFileLoad)(&files[i], 0, &array[fileStarts[i]], files[i].count);
+        dataFileRelease(&files[i], files[i].count);
+    }//for
+
+    oddEvenSort(array, arraySize);
+
+    //write back the result
+    writeResult(array, arraySize, "serialOetsResult.txt");
+
+}//serialOddEven
+
+/**
+ * Odd-even transposition sort on the calling thread: alternating even and odd
+ * phases of compare-exchanges, until an even and an odd phase in a row swap nothing
+ * 
+ * @param array: the numbers to sort
+ * @param arraySize: how many there are
+ * @return void
+ */ 
+void oddEvenSort(elem_t* array, size_t arraySize){
+    
+    bool swapped;
+    bool lastSwapped = true;
+
+    if (arraySize < 2){
+        return;
+    }//if
+
+    for (size_t phase = 0 ; phase < arraySize ; phase++){
+
+        switch (phase % 2){
+
+            //even phase, pairs (0,1), (2,3)...
+            case 0:
+                swapped = SORT(compareExchange)(&array[0], arraySize / 2);
+                break;
+
+            //odd phase, pairs (1,2), (3,4)...
+            case 1:
+                swapped = SORT(compareExchange)(&array[1], (arraySize - 1) / 2);
+                break;
+
+        }//switch
+
+        //an even and an odd phase in a row without swaps means it's sorted
+        if (swapped == false && lastSwapped == false){
+            break;
+        }//if
+
+        lastSwapped = swapped;
+
+    }//for
+
+}//oddEvenSort
+
+/**
+ * Controller for the implementation of parallel odd-even ransposition sort.
+ * Creates the pool of sorting threads (work-stealing, task_pool.h) and runs the
+ * task graph of the whole sort on it
+ * 
+ * Number of threads to be sorting is specified by the user. Each block is sorted
+ * by one thread, so different blocks are sorted at the same time; the main thread
+ * hands out the blocks as they come in and then joins in
+ * The files are read in ahead by readerCount reader threads, readDepth reads at a time
+ * each. A block is sorted as soon as it is in, in whatever order they come, so a slow
+ * file holds up nothing but itself, and each one lands in its own place. Once every
+ * block is sorted, the sorting threads merge them together: each ends up merging one
+ * segment of the output instead of one thread merging block after block
+ * 
+ * After execution finishes, the results are written to a file
+ * 
+ * @param array: pointer to the array of doubles to be sorted
+ * @return void
+ */ 
+void parallelOddEven(elem_t* array){
+    
+    task_pool tasks;
+    pipeline_data pipeline;
+
+    //the sorting threads, plus the main thread handing out the files
+    taskPoolInit(&tasks, thread_count + 1);
+
+    pipeline.tasks = &tasks;
+    pipeline.array = array;
+    taskPoolRun(&tasks, runPipeline, &pipeline);
+
+    //write result of sort to file
+    writeResult(array, fileStarts[totalFiles], "paralllelOetsResult.txt");
+
+    //cleanup
+    taskPoolDestroy(&tasks);
+
+}//parallelOddEven
+
+/**
+ * Task Function
+ * 
+ * Runs on the main thread, as worker 0 of the pool. The graph:
+ *  - an event per block, signalled when the readers have it all in the array
+ *  - a sort per block, after its event
+ *  - a join after every sort, then the merge's nodes after the join
+ * No block is bigger than the numbers split evenly between the threads, so
+ * there are always enough blocks to go around.
+ * The main thread starts the graph, signals each block's event as it comes in,
+ * then runs tasks with the others until the merge is done
+ * 
+ * @param arg: the pipeline_data
+ * @return void
+ */ 
+void runPipeline(void* arg){
+
+    pipeline_data* pipeline = (pipeline_data *) arg;
+    task_graph graph;
+    int* firstBlock = malloc(sizeof(int) * (totalFiles + 1));
+    size_t* blockStarts;
+    int blocks;
+    task_node** fetched;
+    sort_block_data* sorts;
+    task_node* sorted; //every block is sorted
+    task_node* node;
+    SORT(graph_merge) merge;
+    file_prefetch prefetch;
+    size_t share = (fileStarts[totalFiles] + thread_count - 1) / thread_count;
+
+    if (firstBlock == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the task graph\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    //no block bigger than an even share of the numbers, so a few big files (or --block 0)
+    //still give every thread something to sort
+    if (blockSize > 0 && blockSize < share){
+        share = blockSize;
+    }//if
+
+    blocks = dataFilesBlocks(files, totalFiles, share, firstBlock, &blockStarts);
+    fetched = malloc(sizeof(task_node*) * blocks);
+    sorts = malloc(sizeof(sort_block_data) * blocks);
+
+    if (fetched == NULL || sorts == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the task graph\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    taskGraphInit(&graph, pipeline->tasks);
+    sorted = taskGraphNode(&graph, NULL, NULL);
+
+    for (int b = 0 ; b < blocks ; b++){
+
+        sorts[b].array = pipeline->array;
+        sorts[b].blockStart = blockStarts[b];
+        sorts[b].blockLength = blockStarts[b + 1] - blockStarts[b];
+
+        fetched[b] = taskGraphEvent(&graph);
+        node = taskGraphNode(&graph, sortBlock, &sorts[b]);
+        taskGraphDepend(node, fetched[b]);
+        taskGraphDepend(sorted, node);
+
+    }//for
+
+    //the sorted blocks are the runs, one merge segment per thread
+    SORT(graphMergeBuild)(&graph, &merge, sorted, pipeline->array, blockStarts, blocks,
+        pipeline->tasks->thread_count);
+
+    //start the readers, they read the files straight into the array
+    SORT(filePrefetchStart)(&prefetch, files, totalFiles, pipeline->array, blockStarts, firstBlock,
+        readDepth, readerCount);
+    taskGraphStart(&graph);
+
+    //hand out every block as it comes in, the other threads sort the ones already in
+    for (int b = 0 ; b < blocks ; b++){
+        taskGraphSignal(&graph, fetched[filePrefetchNext(&prefetch)]);
+    }//for
+
+    filePrefetchFinish(&prefetch);
+
+    //help with the sorting and merging until it's all done
+    taskGraphWait(&graph);
+
+    SORT(graphMergeFree)(&merge);
+    taskGraphFree(&graph);
+    free(fetched);
+    free(sorts);
+    free(firstBlock);
+    free(blockStarts);
+
+}//runPipeline
+
+/**
+ * Parallel odd-even transposition sort of the numbers on standard input. Nothing
+ * about them is known until the input ends, so the array starts out small and
+ * is grown as the numbers come (see runStream), the blocks are sorted as they
+ * come in, and the merge is only put together at the end
+ * 
+ * After execution finishes, the results are written to a file
+ * 
+ * @return size_t: how many numbers were sorted
+ */ 
+size_t streamOddEven(){
+
+    task_pool tasks;
+    stream_data stream;
+
+    stream.reserved = STREAM_START_BYTES;
+    stream.array = mmap(NULL, stream.reserved, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (stream.array == MAP_FAILED){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    //the sorting threads, plus the main thread reading the input
+    taskPoolInit(&tasks, thread_count + 1);
+
+    stream.tasks = &tasks;
+    taskPoolRun(&tasks, runStream, &stream);
+
+    //write result of sort to file
+    writeResult(stream.array, stream.total, "paralllelOetsResult.txt");
+
+    //cleanup
+    taskPoolDestroy(&tasks);
+    munmap(stream.array, stream.reserved);
+    free(stream.starts);
+
+    return stream.total;
+
+}//streamOddEven
+
+/**
+ * Task Function
+ * 
+ * Runs on the main thread, as worker 0 of the pool. Parses standard input a block
+ * at a time straight into its place in the array and spawns its sort straight
+ * away, so the other threads sort while this one waits on the pipe. When the
+ * array is full it is doubled with mremap: in place if the pages after it are
+ * free, otherwise only once the blocks being sorted are done, since it may move. Whatever is left when
+ * the input ends is cut into one share per thread. Once every block is sorted,
+ * the blocks are merged like the files' blocks are
+ * 
+ * @param arg: the stream_data, everything but tasks is filled in (array and
+ *             reserved change if the array is grown)
+ * @return void
+ */ 
+void runStream(void* arg){
+
+    stream_data* stream = (stream_data *) arg;
+    size_t piece = (blockSize > 0) ? blockSize : ASYNC_DEFAULT_BLOCK; //numbers parsed at a time
+    size_t blockStart = 0;
+    size_t blockLength;
+    size_t share = SIZE_MAX; //most numbers in a block cut at the end
+    size_t got;
+    elem_t* grown;
+    int blocks = 0, capacity = 16;
+    sort_block_data** sorts = malloc(sizeof(sort_block_data*) * capacity);
+    text_stream text;
+    task_group sorting;
+    task_graph graph;
+    SORT(graph_merge) merge;
+    bool ended = false;
+
+    stream->starts = malloc(sizeof(size_t) * (capacity + 1));
+
+    if (sorts == NULL || stream->starts == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the blocks\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    atomic_init(&sorting.pending, 0);
+    textStreamInit(&text, STDIN_FILENO);
+    stream->total = 0;
+
+    while (!ended){
+
+        //room for the next piece, the blocks being sorted keep their place if it can grow in place
+        while (stream->reserved / sizeof(elem_t) - stream->total < piece){
+
+            grown = mremap(stream->array, stream->reserved, stream->reserved * 2, 0);
+
+            if (grown == MAP_FAILED){
+                taskGroupWait(stream->tasks, &sorting);
+                grown = mremap(stream->array, stream->reserved, stream->reserved * 2, MREMAP_MAYMOVE);
+            }//if
+
+            if (grown == MAP_FAILED){
+                fprintf(stderr, "More numbers than fit in memory, sort them from files with --memory\n");
+                exit(EXIT_FAILURE);
+            }//if
+
+            stream->array = grown;
+            stream->reserved *= 2;
+
+        }//while
+
+        //parsed as the key type, so big integer keys stay exact
+        got = SORT(textStreamNext)(&text, &stream->array[stream->total], piece);
+        ended = (got < piece);
+        stream->total += got;
+
+        //whatever is left at the end is cut into even shares, so one big last block
+        //(all of it with --block 0) doesn't leave every thread but one waiting
+        if (ended){
+            share = (stream->total + thread_count - 1) / thread_count;
+        }//if
+
+        //a whole block, or the pieces of whatever is left at the end (one empty block if there was nothing)
+        while ((blockSize > 0 && stream->total - blockStart == blockSize)
+                || (ended && (stream->total > blockStart || blocks == 0))){
+
+            blockLength = stream->total - blockStart;
+
+            if (blockLength > share){
+                blockLength = share;
+            }//if
+
+            if (blocks == capacity){
+
+                capacity *= 2;
+                sorts = realloc(sorts, sizeof(sort_block_data*) * capacity);
+                stream->starts = realloc(stream->starts, sizeof(size_t) * (capacity + 1));
+
+                if (sorts == NULL || stream->starts == NULL){
+                    fprintf(stderr, "Couldn't allocate memory for the blocks\n");
+                    exit(EXIT_FAILURE);
+                }//if
+
+            }//if
+
+            sorts[blocks] = malloc(sizeof(sort_block_data));
+
+            if (sorts[blocks] == NULL){
+                fprintf(stderr, "Couldn't allocate memory for the blocks\n");
+                exit(EXIT_FAILURE);
+            }//if
+
+            sorts[blocks]->array = stream->array;
+            sorts[blocks]->blockStart = blockStart;
+            sorts[blocks]->blockLength = blockLength;
+            stream->starts[blocks++] = blockStart;
+            blockStart += blockLength;
+
+            taskSpawn(stream->tasks, &sorting, sortBlock, sorts[blocks - 1]);
+
+        }//while
+
+    }//while
+
+    stream->starts[blocks] = stream->total;
+    textStreamClose(&text);
+
+    //help sort whatever blocks are left
+    taskGroupWait(stream->tasks, &sorting);
+
+    //the sorted blocks are the runs, one merge segment per thread
+    taskGraphInit(&graph, stream->tasks);
+    SORT(graphMergeBuild)(&graph, &merge, taskGraphNode(&graph, NULL, NULL), stream->array,
+        stream->starts, blocks, stream->tasks->thread_count);
+    taskGraphStart(&graph);
+    taskGraphWait(&graph);
+
+    SORT(graphMergeFree)(&merge);
+    taskGraphFree(&graph);
+
+    for (int b = 0 ; b < blocks ; b++){
+        free(sorts[b]);
+    }//for
+
+    free(sorts);
+
+}//runStream
+
+/**
+ * Task Function
+ * 
+ * Sorts one block where it sits in the array, on whichever thread took the task.
+ * Odd-even transposition takes O(b^2) on one thread, so only short blocks get it:
+ * whole files (--block 0) are n/p numbers, and those are sorted with introsort
+ * 
+ * @param arg: the sort_block_data of the block
+ * @return void
+ */ 
+void sortBlock(void* arg){
+
+    sort_block_data* sort = (sort_block_data *) arg;
+
+    if (sort->blockLength <= ODD_EVEN_CUTOFF){
+        oddEvenSort(&sort->array[sort->blockStart], sort->blockLength);
+    }//if
+
+    else{
+        SORT(quickSort)(&sort->array[sort->blockStart], 0, (ptrdiff_t) sort->blockLength - 1);
+    }//else
+
+}//sortBlock
+
+/**
+ * Sorts the files without ever holding more than memoryBudget bytes of numbers:
+ * the pool's threads sort budget sized runs that go to disk, and the runs are
+ * merged into the result with a k-way merge
+ * 
+ * @return size_t: how many numbers were sorted
+ */ 
+size_t externalSortFiles(){
+
+    worker_pool pool;
+    size_t sorted;
+
+    poolInit(&pool, thread_count);
+    sorted = SORT(externalSort)(&pool, files, totalFiles, memoryBudget, "externalOetsResult.txt");
+    poolDestroy(&pool);
+
+    return sorted;
+
+}//externalSortFiles
+
+/**
+ * Opens all the files of doubles to be sorted (data_files.h): the files and
+ * directories given, or if there are none, the default files (created if they
+ * don't exist). Binary files are mapped into memory, and the opened files are
+ * stored in a globally accessible array along with where each one goes. Text files
+ * are parsed now, unless they are sorted externally: then they are read in a
+ * piece at a time by the sort, so they never have to fit in memory either
+ * 
+ * @param count: how many files or directories were given
+ * @param paths: their names
+ * @return void
+ */ 
+void openFiles(int count, const char* paths[]){
+
+    char** names;
+
+    totalFiles = (count > 0) ? dataFilesList(count, paths, &names) : DEFAULT_FILES;
+
+    if (totalFiles == 0){
+        fprintf(stderr, "No files to sort\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    files = malloc(sizeof(data_file) * totalFiles);
+    fileStarts = malloc(sizeof(size_t) * (totalFiles + 1));
+
+    if (files == NULL || fileStarts == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %d files\n", totalFiles);
+        exit(EXIT_FAILURE);
+    }//if
+
+    if (count > 0){
+        dataFilesOpenNamed(files, totalFiles, names, thread_count, memoryBudget == 0);
+        dataFilesFree(names, totalFiles);
+    }//if
+
+    else{
+        dataFilesOpen(files, DEFAULT_FILES, DEFAULT_NUMS_PER_FILE, MAX, seed, thread_count,
+            memoryBudget == 0);
+    }//else
+
+    dataFilesStarts(files, totalFiles, fileStarts);
+
+}//openFiles
+
+/**
+ * Closes every file opened by openFiles
+ * 
+ * @return void
+ */ 
+void closeFiles(){
+
+    for (int i = 0 ; i < totalFiles ; i++){
+        dataFileClose(&files[i]);
+    }//for
+
+    free(files);
+    free(fileStarts);
+
+}//closeFiles
+
+/**
+ * Writes the provided array of doubles to the provided file
+ * Amount of numbers to be written is based on how many were in the source files
+ * 
+ * @param array: pointer to the array to be written
+ * @param size: how many numbers are in it
+ * @param filename: name of the file the array will be written to
+ * @return void
+ */ 
+void writeResult(elem_t* array, size_t size, const char* filename){
+    
+    //create/truncate file to store results
+    text_writer out;
+
+    textWriterOpen(&out, filename);
+
+    //formatted straight into one big buffer, same text as fprintf(fp, ELEM_FMT " ", ...)
+    SORT(textWriteNumbers)(&out, array, size);
+
+    textWriterClose(&out);
+
+}//writeResult
+
+/**
+ * Displays how to use the program.
+ * I saw that Peter Pacheco used a similar function for his programs,
+ * so I thought I'd add one for mine
+ * 
+ * @param prog_name: name of the program
+ * @return void
+ */ 
+void Usage(const char* prog_name) {
+   fprintf(stderr, "usage:   %s <-s/t> <files> <--seed x> <--memory m> <--inflight r> <--readers f> <--block b>\n",
+        prog_name);
+   fprintf(stderr, "  's':  run serial odd-even transpostion sort\n");
+   fprintf(stderr, "   t:   run parallel odd-even transpostion sort with t threads\n");
+   fprintf(stderr, "files:  data files or directories of them to sort (default data1 ... data%d),\n"
+        "        '-' for standard input (sorted as it comes in when it's the only one)\n", DEFAULT_FILES);
+   fprintf(stderr, "   x:   seed for any data files that have to be made\n");
+   fprintf(stderr, "   m:   sort externally using only m MB for the numbers (result in externalOetsResult.txt)\n");
+   fprintf(stderr, "   r:   reads of the files each reader keeps in flight ahead of the sort (default %d)\n",
+        ASYNC_DEFAULT_DEPTH);
+   fprintf(stderr, "   f:   threads reading the files in (default %d)\n", ASYNC_DEFAULT_READERS);
+   fprintf(stderr, "   b:   numbers sorted as one block as soon as they are in (default %d, 0 for whole files),\n"
+        "        never more than an even share of all the numbers per thread\n", ASYNC_DEFAULT_BLOCK);
+}//Usage
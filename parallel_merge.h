@@ -0,0 +1,950 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Parallel Merge
+ *
+ * parallel_merge.h
+ *
+ * Parallel merge of an array made of already sorted runs (the sorted files of
+ * oets_task.c), run on worker_pool.h
+ *
+ * Merging the runs two at a time leaves the last merges, over nearly the whole
+ * output, to a single thread. Instead the output is cut into p equal segments,
+ * one per thread, and every thread builds its own segment:
+ *
+ *  1. Co-ranking: thread b finds, in every run, how many of its numbers are among
+ *     the first chunkStart(b, p, n) numbers of the output. This is merge path
+ *     (where a diagonal of the merge grid crosses the path) for k runs instead of
+ *     two. Since the runs are sorted, those numbers are a prefix of each run
+ *  2. Every thread merges its piece of every run (between its own split and the
+ *     next thread's) into its segment of the output
+ *
+ * Every segment is exactly chunkStart(b, p, n) long, whatever the numbers are:
+ * runs full of equal numbers split as evenly as distinct ones, and nobody merges
+ * more than their share
+ *
+ * Equal numbers are ordered by run, so the split is always well defined: number
+ * i of run r comes before number j of run s if it is smaller, or equal and r < s
+ * (or r == s and i < j). Co-ranking keeps a window [low, high] per run that the
+ * split must lie in, and narrows them all at once: a pivot is ranked in every
+ * run with a binary search, and either it and everything before it is in the
+ * prefix, or it and everything after it isn't. The pivot is the weighted median
+ * of the windows' middle numbers (weighted by window size), so at least half of
+ * what's left is in windows that lose at least half: every step throws out a
+ * quarter or more, however the numbers are spread over the runs. Picking the
+ * middle of the widest window instead takes a step per run when the runs don't
+ * overlap (or are all equal)
+ *
+ * Step 2 is done in place, with only a small share of the keys' size on the side.
+ * The array is cut into blocks, and every block counts the keys in it not merged
+ * yet. Each thread merges the fronts of its pieces with a tree of losers
+ * (loser_tree.h) and writes its output a block at a time into blocks whose keys
+ * are all merged, whoever's they were: a thread that merges the last key of a
+ * block gets it. Until its own input has freed some, a thread writes into a few
+ * spare blocks. The output that goes before a thread's first whole block of the
+ * array and after its last one (the fragments) is kept aside. Once every thread
+ * is done, every block of output is in some block, and all of them have to move
+ * to their places. Following where each place's block is gives chains of moves
+ * (or cycles), which are lined up and cut into one equal part per thread; every
+ * part first keeps the blocks the next part will want, then moves its own. The
+ * fragments are copied into place last
+ *
+ * At most 3 blocks' worth of keys per run are merged and not yet free, so blocks
+ * are made small enough that 3 spare blocks per run and thread are a 1/16th of
+ * the keys (MERGE_SPARE_SHARE). Runs too short for blocks of MERGE_MIN_BLOCK
+ * bytes are first merged in groups of adjacent runs, each group by one thread
+ * through its own stretch of one buffer made with the rest of the merge's memory.
+ * Nothing a group or a segment works with is allocated while it runs
+ *
+ * The same merge can also be nodes of a task graph (task_graph.h) instead of a
+ * pool job: a node per group, per split, per segment, per part of the moves and
+ * per pair of fragments, with joins between the steps. The segments wait for
+ * every split, since they write over the runs the splits search
+ *
+ * Methods (one of each per type, T is the key type):
+ *  - parallelMerge_<type>(worker_pool* pool, T* array, const size_t* starts, int runs) -> void
+ *      Sorts array, which is runs sorted runs, run r being [starts[r], starts[r + 1]),
+ *      with every thread of the pool. The runs can be any size
+ *
+ *  - graphMergeBuild_<type>(task_graph* graph, graph_merge* merge, task_node* after, T* array,
+ *                           const size_t* starts, int runs, int segments) -> void
+ *      Adds the nodes of the same merge, cut into segments, to graph. They start once
+ *      after has finished
+ *
+ *  - graphMergeFree_<type>(graph_merge* merge) -> void
+ *      Frees what the merge's nodes shared, once the graph has run
+ *
+ *  - graphMergeGroup_<type>, graphMergeSplit_<type>, graphMergeSegment_<type>, graphMergePlan_<type>,
+ *    graphMergeSave_<type>, graphMergeMove_<type>, graphMergeFragments_<type>(void* arg) -> void
+ *      Task functions, one for every kind of merge node
+ *
+ *  - graphMergeStep_<type>(task_graph* graph, graph_merge* merge, task_node* before, task_fn fn,
+ *                          int from, int count) -> task_node*
+ *      Adds a node of fn for every index after before, and a join after all of them
+ *
+ *  - parallelMergeJob_<type>(int rank, void* arg) -> void
+ *      Pool job, what every thread runs for one merge
+ *
+ *  - mergeSetup_<type>, mergeGroup_<type>, mergeSplit_<type>, mergeSegment_<type>, mergePlan_<type>,
+ *    mergeSave_<type>, mergeMove_<type>, mergeFragments_<type>
+ *      The steps of the merge, shared by both
+ *
+ *  - mergeGroups_<type>(size_t n, int runs, int segments) -> bool
+ *      Whether the runs are short enough to be merged in groups first (which takes a
+ *      buffer as big as the keys, only ever needed when there are few of them)
+ *
+ *  - parallelMergeBytes_<type>(size_t n, int runs, int segments) -> size_t
+ *      At most how much memory a merge of n keys takes besides the keys themselves
+ *
+ *  - mergeSlot_<type>, mergeWhole_<type>, mergeChainOf_<type>, mergeSaved_<type>
+ *      Where a block is, where a segment's whole blocks are, which chain a move is
+ *      on and where a part keeps a block
+ *
+ *  - coRank_<type>(const T* array, const size_t* starts, int runs, size_t m, size_t* split) -> void
+ *      Sets split[r] to how many numbers of run r are among the first m of the
+ *      output
+ *
+ *  - coRankCompare_<type>(const void* a, const void* b) -> int
+ *      qsort comparison of two windows' middle numbers, equal ones by run
+ *
+ *  - lowerBound_<type>(const T* array, size_t n, T key) -> size_t
+ *      First index of array holding something not less than key
+ *
+ *  - upperBound_<type>(const T* array, size_t n, T key) -> size_t
+ *      First index of array holding something greater than key
+ *
+ * Resources:
+ *  - Odeh, Green, Mwassi, Shmueli and Birk, "Merge Path - Parallel Merging Made
+ *    Simple" (2012)
+ *  - Varman, Scheufler, Iyer and Ricard, "Merging Multiple Lists on Hierarchical-
+ *    Memory Multiprocessors" (1991)
+ *      splitting k sorted lists at an exact rank
+ *  - Frederickson and Johnson, "The Complexity of Selection and Ranking in X + Y
+ *    and Matrices with Sorted Columns" (1982)
+ *      weighted median of the middles as the pivot
+ *  - Kronrod, "An Optimal Ordering Algorithm Without a Field of Operation" (1969),
+ *    and Katajainen, Pasanen and Teuhola, "Practical In-Place Mergesort" (1996)
+ *      merging in place by recycling blocks of the input as output
+ */
+#ifndef PARALLEL_MERGE_H
+#define PARALLEL_MERGE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "sort_core.h"
+#include "worker_pool.h"
+#include "task_graph.h"
+#include "spin_barrier.h"
+#include "loser_tree.h"
+
+#define MERGE_MIN_BLOCK 1024 //bytes in the smallest block the merge moves around
+#define MERGE_SPARE_SHARE 16 //the spare blocks are at most 1/MERGE_SPARE_SHARE of the keys
+#define MERGE_NONE SIZE_MAX //no slot, for blocks that are filled from fragments
+
+#define PARALLEL_MERGE_DEFINE(T, S) \
+\
+static inline size_t lowerBound_##S(const T* array, size_t n, T key){ \
+    size_t low = 0, high = n, mid; \
+    while (low < high){ \
+        mid = low + (high - low) / 2; \
+        if (array[mid] < key){ \
+            low = mid + 1; \
+        } \
+        else{ \
+            high = mid; \
+        } \
+    } \
+    return low; \
+} \
+\
+static inline size_t upperBound_##S(const T* array, size_t n, T key){ \
+    size_t low = 0, high = n, mid; \
+    while (low < high){ \
+        mid = low + (high - low) / 2; \
+        if (key < array[mid]){ \
+            high = mid; \
+        } \
+        else{ \
+            low = mid + 1; \
+        } \
+    } \
+    return low; \
+} \
+\
+/* the middle of one run's window, a candidate pivot */ \
+typedef struct { \
+    T key; \
+    int run; \
+    size_t width; \
+} co_rank_entry_##S; \
+\
+static int coRankCompare_##S(const void* a, const void* b){ \
+    const co_rank_entry_##S* x = (const co_rank_entry_##S *) a; \
+    const co_rank_entry_##S* y = (const co_rank_entry_##S *) b; \
+    if (x->key < y->key || (x->key == y->key && x->run < y->run)){ \
+        return -1; \
+    } \
+    return (y->key < x->key || (x->key == y->key && y->run < x->run)) ? 1 : 0; \
+} \
+\
+static inline void coRank_##S(const T* array, const size_t* starts, int runs, size_t m, size_t* split){ \
+    size_t* low = malloc(sizeof(size_t) * runs); \
+    size_t* high = malloc(sizeof(size_t) * runs); \
+    co_rank_entry_##S* middles = malloc(sizeof(co_rank_entry_##S) * runs); \
+    size_t below, mid, total, seen; \
+    int open, pivotRun, i; \
+    T pivot; \
+    if (low == NULL || high == NULL || middles == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge split\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    for (int r = 0 ; r < runs ; r++){ \
+        low[r] = 0; \
+        high[r] = starts[r + 1] - starts[r]; \
+    } \
+    while (true){ \
+        /* the pivot is the weighted median of the windows' middles */ \
+        open = 0; \
+        total = 0; \
+        for (int r = 0 ; r < runs ; r++){ \
+            if (high[r] > low[r]){ \
+                middles[open].width = high[r] - low[r]; \
+                middles[open].key = array[starts[r] + low[r] + middles[open].width / 2]; \
+                middles[open].run = r; \
+                total += middles[open].width; \
+                open++; \
+            } \
+        } \
+        if (open == 0){ \
+            break; /* every window is closed, low is the split */ \
+        } \
+        qsort(middles, open, sizeof(co_rank_entry_##S), coRankCompare_##S); \
+        seen = 0; \
+        for (i = 0 ; 2 * (seen + middles[i].width) < total ; i++){ \
+            seen += middles[i].width; \
+        } \
+        pivotRun = middles[i].run; \
+        pivot = middles[i].key; \
+        mid = low[pivotRun] + middles[i].width / 2; \
+        /* where the pivot would go in every run: after equal numbers of lower runs, */ \
+        /* before equal numbers of higher ones. The pivot comes after every earlier */ \
+        /* pivot found to be in the prefix and before every one that wasn't, so it */ \
+        /* always goes somewhere inside the windows */ \
+        below = 0; \
+        for (int r = 0 ; r < runs ; r++){ \
+            const T* window = &array[starts[r] + low[r]]; \
+            size_t length = high[r] - low[r]; \
+            split[r] = low[r] + ((r < pivotRun) ? upperBound_##S(window, length, pivot) : \
+                (r > pivotRun) ? lowerBound_##S(window, length, pivot) : mid - low[r]); \
+            below += split[r]; \
+        } \
+        if (below == m){ \
+            break; \
+        } \
+        /* the pivot is in the prefix: so is everything before it */ \
+        if (below < m){ \
+            memcpy(low, split, sizeof(size_t) * runs); \
+            low[pivotRun] = mid + 1; \
+        } \
+        /* it isn't: neither is anything after it */ \
+        else{ \
+            memcpy(high, split, sizeof(size_t) * runs); \
+        } \
+    } \
+    if (open == 0){ \
+        memcpy(split, low, sizeof(size_t) * runs); \
+    } \
+    free(low); \
+    free(high); \
+    free(middles); \
+} \
+\
+/* a merge, shared by every thread or node working on it. Segment b of the output is */ \
+/* [chunkStart(b), chunkStart(b + 1)) and split b is where it starts in every run */ \
+typedef struct graph_merge_##S { \
+    T* array; \
+    size_t n; \
+    int segments; \
+    const size_t* given; /* the runs as they were given, givenRuns + 1 starts */ \
+    int givenRuns; \
+    int* groups; /* given runs [groups[g], groups[g + 1]) are merged into run g first */ \
+    int groupCount; /* 0 if the runs are long enough as they are */ \
+    size_t* starts; /* the runs the block merge sees, runs + 1 of them */ \
+    int runs; \
+    size_t* bounds; /* [split][run], segments + 1 splits */ \
+    size_t block; /* keys in a block */ \
+    size_t blocks; /* blocks of the array, the last one can be short */ \
+    atomic_size_t* left; /* [block], keys in it not merged yet */ \
+    size_t* slots; /* [block], where the output that goes in block j was written, MERGE_NONE */ \
+                   /* for the blocks that hold the ends of segments (those go in fragments) */ \
+    T* spare; /* spare blocks, slot blocks + i is spare block i */ \
+    size_t* spareStarts; /* segment b's spare blocks are [spareStarts[b], spareStarts[b + 1]) */ \
+    T* fragments; /* [segment][2] blocks, the output before the first and after the last whole block */ \
+    size_t* chain; /* the slots of every chain of moves, one after the other */ \
+    size_t* chainStarts; /* chains + 1 of them */ \
+    bool* cycles; /* [chain], whether it goes round (or ends at a slot nobody needs) */ \
+    size_t chains; \
+    T* saved; /* [segment][3] blocks, what the move nodes keep before writing over */ \
+    T* groupBuffer; /* the groups are merged into it at their own offsets, then copied back */ \
+    T* fronts; /* [given run] while grouping, [segment][run] after, the trees' first keys */ \
+    bool* has; /* the same, whether there is a first key */ \
+    size_t* reading; /* [given run] while grouping, [segment][4 * run] after, see mergeSegment */ \
+    size_t* empty; /* stacks of the blocks every segment can write */ \
+    size_t* emptyStarts; /* segment b's is [emptyStarts[b], emptyStarts[b + 1]) */ \
+    struct graph_merge_part_##S* parts; /* one per split, segment or group */ \
+} graph_merge_##S; \
+\
+/* one split, segment or group of a merge in a task graph */ \
+typedef struct graph_merge_part_##S { \
+    graph_merge_##S* merge; \
+    int index; \
+} graph_merge_part_##S; \
+\
+/* shared by every thread of one merge on the worker pool */ \
+typedef struct { \
+    graph_merge_##S merge; \
+    spin_barrier barrier; \
+} parallel_merge_data_##S; \
+\
+/* where a slot's block is: one of the array or a spare one */ \
+static inline T* mergeSlot_##S(const graph_merge_##S* merge, size_t slot){ \
+    if (slot < merge->blocks){ \
+        return &merge->array[slot * merge->block]; \
+    } \
+    return &merge->spare[(slot - merge->blocks) * merge->block]; \
+} \
+\
+/* segment b's whole blocks are [*whole, *after), before and after them are its fragments */ \
+static inline void mergeWhole_##S(const graph_merge_##S* merge, int b, size_t* whole, size_t* after){ \
+    size_t first = chunkStart(b, merge->segments, merge->n); \
+    size_t last = chunkStart(b + 1, merge->segments, merge->n); \
+    size_t up = (first + merge->block - 1) / merge->block * merge->block; \
+    *whole = (up < last) ? up : last; \
+    *after = last / merge->block * merge->block; \
+    *after = (*after > *whole) ? *after : *whole; \
+} \
+\
+/* whether runs of n keys in all are too short for blocks of MERGE_MIN_BLOCK bytes, */ \
+/* so groups of them are merged through a buffer first */ \
+static inline bool mergeGroups_##S(size_t n, int runs, int segments){ \
+    size_t minBlock = (MERGE_MIN_BLOCK / sizeof(T) > 0) ? MERGE_MIN_BLOCK / sizeof(T) : 1; \
+    return runs > 1 && n / (3 * MERGE_SPARE_SHARE * (size_t) runs * segments) < minBlock; \
+} \
+\
+/* at most how many bytes a merge of n keys in runs runs, cut into segments, allocates */ \
+/* besides the keys: what mergeSetup sizes, the plan's tables, and every segment's tree */ \
+/* and co-ranking at once. Grouped runs are bounded by the fewest groups (the biggest */ \
+/* blocks) and the most (the biggest tables) there can be */ \
+static inline size_t parallelMergeBytes_##S(size_t n, int runs, int segments){ \
+    size_t minBlock = (MERGE_MIN_BLOCK / sizeof(T) > 0) ? MERGE_MIN_BLOCK / sizeof(T) : 1; \
+    size_t r = (size_t) runs, block, blocks, spares, work; \
+    size_t bytes = (r + 1) * (sizeof(size_t) + sizeof(int)) \
+        + (r + segments + 1) * sizeof(graph_merge_part_##S); \
+    if (runs < 2){ \
+        return bytes; \
+    } \
+    if (mergeGroups_##S(n, runs, segments)){ \
+        bytes += sizeof(T) * (n + 1); \
+        block = n / (3 * MERGE_SPARE_SHARE * 2 * (size_t) segments); \
+        r = n / (minBlock * 3 * MERGE_SPARE_SHARE * segments); \
+        r = (r > 2) ? r : 2; \
+    } \
+    else{ \
+        block = n / (3 * MERGE_SPARE_SHARE * r * segments); \
+    } \
+    block = (block > minBlock) ? block : minBlock; \
+    blocks = (n + block - 1) / block; \
+    spares = (3 * r + 1) * segments; \
+    spares = (spares < blocks) ? spares : blocks; \
+    work = (r * segments > (size_t) runs) ? r * segments : (size_t) runs; \
+    /* spare blocks, fragments and saved blocks */ \
+    bytes += sizeof(T) * (spares + 5 * (size_t) segments + 1) * block; \
+    /* left and slots, the plan's holder, seen, chain, chainStarts and cycles */ \
+    bytes += blocks * (sizeof(atomic_size_t) + 2 * sizeof(size_t) + 2 * sizeof(bool)) \
+        + (blocks + spares + 1) * sizeof(size_t) + 2 * (blocks + 1) * sizeof(size_t); \
+    /* the free-block stacks */ \
+    bytes += (blocks + spares + 2 * r * segments + 2 * (size_t) segments + 1) * sizeof(size_t); \
+    /* splits, fronts, has and reading */ \
+    bytes += ((size_t) segments + 1) * r * sizeof(size_t) \
+        + (work + 1) * (sizeof(T) + sizeof(bool) + 4 * sizeof(size_t)); \
+    /* the trees of losers (and the winners they are built with) and co-rankings, of */ \
+    /* every group or every segment at once */ \
+    bytes += work * (6 * sizeof(loser_entry_##S) + 2 * sizeof(size_t) + sizeof(co_rank_entry_##S)); \
+    return bytes; \
+} \
+\
+static inline void mergeSetup_##S(graph_merge_##S* merge, T* array, const size_t* starts, int runs, int segments){ \
+    size_t n = starts[runs]; \
+    size_t minBlock = (MERGE_MIN_BLOCK / sizeof(T) > 0) ? MERGE_MIN_BLOCK / sizeof(T) : 1; \
+    size_t target = minBlock * 3 * MERGE_SPARE_SHARE * segments; /* shortest run worth block merging */ \
+    size_t length = 0, whole, after, spares, most, work; \
+    int g = 0; \
+    merge->array = array; \
+    merge->n = n; \
+    merge->segments = segments; \
+    merge->given = starts; \
+    merge->givenRuns = runs; \
+    merge->groupCount = 0; \
+    merge->groups = NULL; \
+    merge->bounds = NULL; \
+    merge->left = NULL; \
+    merge->slots = NULL; \
+    merge->spare = NULL; \
+    merge->spareStarts = NULL; \
+    merge->fragments = NULL; \
+    merge->chain = NULL; \
+    merge->chainStarts = NULL; \
+    merge->cycles = NULL; \
+    merge->saved = NULL; \
+    merge->groupBuffer = NULL; \
+    merge->fronts = NULL; \
+    merge->has = NULL; \
+    merge->reading = NULL; \
+    merge->empty = NULL; \
+    merge->emptyStarts = NULL; \
+    merge->starts = malloc(sizeof(size_t) * (runs + 1)); \
+    merge->parts = malloc(sizeof(graph_merge_part_##S) * (runs + segments + 1)); \
+    if (merge->starts == NULL || merge->parts == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    /* short runs would need tiny blocks: adjacent ones are merged into runs of at least target first */ \
+    if (mergeGroups_##S(n, runs, segments)){ \
+        merge->groups = malloc(sizeof(int) * (runs + 1)); \
+        if (merge->groups == NULL){ \
+            fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+            exit(EXIT_FAILURE); \
+        } \
+        merge->groups[0] = 0; \
+        for (int r = 0 ; r < runs ; r++){ \
+            length += starts[r + 1] - starts[r]; \
+            if (length >= target){ \
+                merge->groups[++g] = r + 1; \
+                length = 0; \
+            } \
+        } \
+        /* whatever is left over joins the last group, or is one of its own */ \
+        if (merge->groups[g] < runs){ \
+            if (g > 0){ \
+                merge->groups[g] = runs; \
+            } \
+            else{ \
+                merge->groups[++g] = runs; \
+            } \
+        } \
+        merge->groupCount = g; \
+        for (g = 0 ; g <= merge->groupCount ; g++){ \
+            merge->starts[g] = starts[merge->groups[g]]; \
+        } \
+        merge->runs = merge->groupCount; \
+        /* one buffer for every group, made here instead of by every group's merge; the */ \
+        /* runs are this short only when the keys are few (see mergeGroups) */ \
+        merge->groupBuffer = malloc(sizeof(T) * (n + 1)); \
+        if (merge->groupBuffer == NULL){ \
+            fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+            exit(EXIT_FAILURE); \
+        } \
+    } \
+    else{ \
+        memcpy(merge->starts, starts, sizeof(size_t) * (runs + 1)); \
+        merge->runs = runs; \
+    } \
+    /* the trees' fronts and read positions, for the groups and then for the segments */ \
+    work = (size_t) merge->runs * segments; \
+    work = (work > (size_t) runs) ? work : (size_t) runs; \
+    merge->fronts = malloc(sizeof(T) * (work + 1)); \
+    merge->has = malloc(sizeof(bool) * (work + 1)); \
+    merge->reading = malloc(sizeof(size_t) * (4 * work + 1)); \
+    if (merge->fronts == NULL || merge->has == NULL || merge->reading == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    if (merge->runs < 2){ \
+        return; \
+    } \
+    /* blocks small enough that every segment's spare ones are a small share of the keys */ \
+    runs = merge->runs; \
+    merge->block = n / (3 * MERGE_SPARE_SHARE * (size_t) runs * segments); \
+    merge->block = (merge->block > minBlock) ? merge->block : minBlock; \
+    merge->blocks = (n + merge->block - 1) / merge->block; \
+    merge->bounds = malloc(sizeof(size_t) * (segments + 1) * runs); \
+    merge->left = malloc(sizeof(atomic_size_t) * merge->blocks); \
+    merge->slots = malloc(sizeof(size_t) * merge->blocks); \
+    merge->spareStarts = malloc(sizeof(size_t) * (segments + 1)); \
+    merge->emptyStarts = malloc(sizeof(size_t) * (segments + 1)); \
+    merge->fragments = malloc(sizeof(T) * 2 * segments * merge->block); \
+    merge->saved = malloc(sizeof(T) * 3 * segments * merge->block); \
+    if (merge->bounds == NULL || merge->left == NULL || merge->slots == NULL || merge->spareStarts == NULL \
+            || merge->emptyStarts == NULL || merge->fragments == NULL || merge->saved == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    /* the first and last splits are known */ \
+    memset(merge->bounds, 0, sizeof(size_t) * runs); \
+    for (int r = 0 ; r < runs ; r++){ \
+        merge->bounds[segments * runs + r] = merge->starts[r + 1] - merge->starts[r]; \
+    } \
+    for (size_t j = 0 ; j < merge->blocks ; j++){ \
+        atomic_init(&merge->left[j], (j + 1 < merge->blocks) ? merge->block : n - j * merge->block); \
+        merge->slots[j] = MERGE_NONE; \
+    } \
+    /* a segment never needs more spare blocks than 3 per run (see mergeSegment), */ \
+    /* or than it has whole blocks of output */ \
+    /* its stack holds those, and at most every block its pieces touch, 2 more per run */ \
+    /* than the blocks in the segment */ \
+    merge->spareStarts[0] = 0; \
+    merge->emptyStarts[0] = 0; \
+    for (int b = 0 ; b < segments ; b++){ \
+        mergeWhole_##S(merge, b, &whole, &after); \
+        spares = (after - whole) / merge->block; \
+        most = 3 * (size_t) runs + 1; \
+        spares = (spares < most) ? spares : most; \
+        merge->spareStarts[b + 1] = merge->spareStarts[b] + spares; \
+        merge->emptyStarts[b + 1] = merge->emptyStarts[b] + spares \
+            + (chunkStart(b + 1, segments, n) - chunkStart(b, segments, n)) / merge->block + 2 * (size_t) runs; \
+    } \
+    /* only the spare blocks a segment runs short of are ever touched */ \
+    merge->spare = malloc(sizeof(T) * (merge->spareStarts[segments] * merge->block + 1)); \
+    merge->empty = malloc(sizeof(size_t) * (merge->emptyStarts[segments] + 1)); \
+    if (merge->spare == NULL || merge->empty == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+} \
+\
+/* merges the given runs of group g into one run where they are, through the group's */ \
+/* own stretch of groupBuffer */ \
+static inline void mergeGroup_##S(graph_merge_##S* merge, int g){ \
+    int first = merge->groups[g]; \
+    int k = merge->groups[g + 1] - first; \
+    const size_t* starts = &merge->given[first]; \
+    size_t length = starts[k] - starts[0]; \
+    T* buffer = &merge->groupBuffer[starts[0]]; \
+    T* fronts = &merge->fronts[first]; \
+    bool* has = &merge->has[first]; \
+    size_t* next = &merge->reading[first]; \
+    size_t used = 0; \
+    loser_tree_##S tree; \
+    int r; \
+    if (k < 2 || length == 0){ \
+        return; \
+    } \
+    for (r = 0 ; r < k ; r++){ \
+        next[r] = starts[r]; \
+        has[r] = starts[r] < starts[r + 1]; \
+        if (has[r]){ \
+            fronts[r] = merge->array[next[r]++]; \
+        } \
+    } \
+    loserTreeInit_##S(&tree, fronts, has, k); \
+    while (!loserTreeEmpty_##S(&tree)){ \
+        buffer[used++] = tree.winner.key; \
+        r = tree.winner.run; \
+        if (next[r] < starts[r + 1]){ \
+            loserTreeReplace_##S(&tree, merge->array[next[r]++]); \
+        } \
+        else{ \
+            loserTreeDrop_##S(&tree); \
+        } \
+    } \
+    memcpy(&merge->array[starts[0]], buffer, sizeof(T) * length); \
+    loserTreeFree_##S(&tree); \
+} \
+\
+/* co-ranks split b, where segment b starts in every run */ \
+static inline void mergeSplit_##S(graph_merge_##S* merge, int b){ \
+    coRank_##S(merge->array, merge->starts, merge->runs, chunkStart(b, merge->segments, merge->n), \
+        &merge->bounds[b * merge->runs]); \
+} \
+\
+/* merges segment b's piece of every run with a tree of losers. The output goes block by */ \
+/* block into blocks of the array its own input has emptied (spare ones until there are */ \
+/* some), and slots records where. Every block counts the keys in it not merged yet; */ \
+/* whoever merges its last key gets the block. At most 3 blocks' worth of keys per run */ \
+/* are merged but not in a block that came back (the block it is reading, and the */ \
+/* blocks at both ends of its piece, shared with whoever has the keys around it), */ \
+/* so 3 spare blocks per run always keep the merge going */ \
+static inline void mergeSegment_##S(graph_merge_##S* merge, int b){ \
+    int runs = merge->runs; \
+    size_t size = merge->block; \
+    size_t first = chunkStart(b, merge->segments, merge->n); \
+    size_t last = chunkStart(b + 1, merge->segments, merge->n); \
+    const size_t* mine = &merge->bounds[b * runs]; \
+    const size_t* next = &merge->bounds[(b + 1) * runs]; \
+    size_t* reading = &merge->reading[4 * (size_t) b * runs]; /* next key of every piece */ \
+    size_t* ends = reading + runs; /* end of every piece */ \
+    size_t* counted = ends + runs; /* up to where every piece has handed its keys back */ \
+    size_t* stops = counted + runs; /* where it hands them back next, the end of a block or the piece */ \
+    T* fronts = &merge->fronts[(size_t) b * runs]; \
+    bool* has = &merge->has[(size_t) b * runs]; \
+    size_t* empty = &merge->empty[merge->emptyStarts[b]]; /* blocks this segment can write */ \
+    size_t top = 0; \
+    size_t whole, after, block, j, count; \
+    T* out; \
+    size_t room; \
+    loser_tree_##S tree; \
+    int r; \
+    for (r = 0 ; r < runs ; r++){ \
+        reading[r] = merge->starts[r] + mine[r]; \
+        ends[r] = merge->starts[r] + next[r]; \
+        counted[r] = reading[r]; \
+        stops[r] = (reading[r] / size + 1) * size; \
+        stops[r] = (stops[r] < ends[r]) ? stops[r] : ends[r]; \
+        has[r] = reading[r] < ends[r]; \
+        if (has[r]){ \
+            fronts[r] = merge->array[reading[r]]; \
+        } \
+    } \
+    for (size_t s = merge->spareStarts[b + 1] ; s > merge->spareStarts[b] ; s--){ \
+        empty[top++] = merge->blocks + s - 1; \
+    } \
+    mergeWhole_##S(merge, b, &whole, &after); \
+    block = whole / size; \
+    /* the front fragment, then whole blocks, then the back fragment */ \
+    out = &merge->fragments[2 * b * size]; \
+    room = whole - first; \
+    loserTreeInit_##S(&tree, fronts, has, runs); \
+    while (!loserTreeEmpty_##S(&tree)){ \
+        if (room == 0){ \
+            if (block < after / size){ \
+                if (top == 0){ \
+                    fprintf(stderr, "The merge ran out of free blocks\n"); \
+                    exit(EXIT_FAILURE); \
+                } \
+                merge->slots[block] = empty[--top]; \
+                out = mergeSlot_##S(merge, merge->slots[block++]); \
+                room = size; \
+            } \
+            else{ \
+                out = &merge->fragments[(2 * b + 1) * size]; \
+                room = last - after; \
+            } \
+        } \
+        *out++ = tree.winner.key; \
+        room--; \
+        r = tree.winner.run; \
+        /* done with a block (or the piece): hand its keys back, the last one in gets it */ \
+        if (++reading[r] == stops[r]){ \
+            j = (reading[r] - 1) / size; \
+            count = reading[r] - counted[r]; \
+            counted[r] = reading[r]; \
+            stops[r] = (reading[r] + size < ends[r]) ? reading[r] + size : ends[r]; \
+            if (atomic_fetch_sub_explicit(&merge->left[j], count, memory_order_acq_rel) == count \
+                    && (j + 1) * size <= merge->n){ \
+                empty[top++] = j; \
+            } \
+        } \
+        if (reading[r] < ends[r]){ \
+            loserTreeReplace_##S(&tree, merge->array[reading[r]]); \
+        } \
+        else{ \
+            loserTreeDrop_##S(&tree); \
+        } \
+    } \
+    loserTreeFree_##S(&tree); \
+} \
+\
+/* every block of output has to get from its slot to its place. Following where each */ \
+/* place's block is gives chains: from a place nothing is in, through places whose */ \
+/* blocks are elsewhere, to a slot nobody needs (a spare, or the block of a fragment), */ \
+/* or round in a cycle. Moving every block one step along its chain finishes the merge, */ \
+/* so the chains are lined up one after the other and cut into equal parts for the */ \
+/* move nodes */ \
+static inline void mergePlan_##S(graph_merge_##S* merge){ \
+    size_t blocks = merge->blocks; \
+    size_t total = blocks + merge->spareStarts[merge->segments]; \
+    size_t* holder = malloc(sizeof(size_t) * blocks); /* [block], whose output is in it */ \
+    bool* seen = calloc(blocks, sizeof(bool)); \
+    size_t used = 0, slot; \
+    merge->chain = malloc(sizeof(size_t) * (total + 1)); \
+    merge->chainStarts = malloc(sizeof(size_t) * (blocks + 1)); \
+    merge->cycles = malloc(sizeof(bool) * (blocks + 1)); \
+    if (holder == NULL || seen == NULL || merge->chain == NULL || merge->chainStarts == NULL \
+            || merge->cycles == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the merge\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    for (size_t j = 0 ; j < blocks ; j++){ \
+        holder[j] = MERGE_NONE; \
+    } \
+    for (size_t j = 0 ; j < blocks ; j++){ \
+        if (merge->slots[j] < blocks){ \
+            holder[merge->slots[j]] = j; \
+        } \
+    } \
+    merge->chains = 0; \
+    /* chains that start at an empty place */ \
+    for (size_t j = 0 ; j < blocks ; j++){ \
+        if (merge->slots[j] == MERGE_NONE || merge->slots[j] == j || holder[j] != MERGE_NONE){ \
+            continue; \
+        } \
+        merge->chainStarts[merge->chains] = used; \
+        merge->cycles[merge->chains++] = false; \
+        for (slot = j ; slot < blocks && merge->slots[slot] != MERGE_NONE ; slot = merge->slots[slot]){ \
+            merge->chain[used++] = slot; \
+            seen[slot] = true; \
+        } \
+        merge->chain[used++] = slot; \
+    } \
+    /* everything else out of place is on a cycle */ \
+    for (size_t j = 0 ; j < blocks ; j++){ \
+        if (merge->slots[j] == MERGE_NONE || merge->slots[j] == j || seen[j]){ \
+            continue; \
+        } \
+        merge->chainStarts[merge->chains] = used; \
+        merge->cycles[merge->chains++] = true; \
+        slot = j; \
+        do { \
+            merge->chain[used++] = slot; \
+            seen[slot] = true; \
+            slot = merge->slots[slot]; \
+        } while (slot != j); \
+    } \
+    merge->chainStarts[merge->chains] = used; \
+    free(holder); \
+    free(seen); \
+} \
+\
+/* which chain position i is on */ \
+static inline size_t mergeChainOf_##S(const graph_merge_##S* merge, size_t i){ \
+    size_t low = 0, high = merge->chains, mid; \
+    while (high - low > 1){ \
+        mid = low + (high - low) / 2; \
+        if (merge->chainStarts[mid] <= i){ \
+            low = mid; \
+        } \
+        else{ \
+            high = mid; \
+        } \
+    } \
+    return low; \
+} \
+\
+/* the block part p keeps before anything moves: 0 is the first block of its part if a */ \
+/* chain runs into it, 1 is the first block of a cycle that runs out of it, 2 is its own */ \
+static inline T* mergeSaved_##S(const graph_merge_##S* merge, int p, int which){ \
+    return &merge->saved[(3 * (size_t) p + which) * merge->block]; \
+} \
+\
+/* part p keeps the blocks the part before it and the part with the end of a cycle */ \
+/* will want after it has written over them */ \
+static inline void mergeSave_##S(graph_merge_##S* merge, int p){ \
+    size_t length = merge->chainStarts[merge->chains]; \
+    size_t first = chunkStart(p, merge->segments, length); \
+    size_t last = chunkStart(p + 1, merge->segments, length); \
+    size_t c; \
+    if (first == last){ \
+        return; \
+    } \
+    c = mergeChainOf_##S(merge, first); \
+    if (merge->chainStarts[c] < first){ \
+        memcpy(mergeSaved_##S(merge, p, 0), mergeSlot_##S(merge, merge->chain[first]), sizeof(T) * merge->block); \
+    } \
+    c = mergeChainOf_##S(merge, last - 1); \
+    if (merge->cycles[c] && merge->chainStarts[c] >= first && merge->chainStarts[c + 1] > last){ \
+        memcpy(mergeSaved_##S(merge, p, 1), mergeSlot_##S(merge, merge->chain[merge->chainStarts[c]]), \
+            sizeof(T) * merge->block); \
+    } \
+} \
+\
+/* moves every block of part p one step along its chain */ \
+static inline void mergeMove_##S(graph_merge_##S* merge, int p){ \
+    size_t length = merge->chainStarts[merge->chains]; \
+    size_t first = chunkStart(p, merge->segments, length); \
+    size_t last = chunkStart(p + 1, merge->segments, length); \
+    size_t bytes = sizeof(T) * merge->block; \
+    size_t begin, end, stop; \
+    const T* from; \
+    bool local; \
+    int head; \
+    if (first == last){ \
+        return; \
+    } \
+    for (size_t c = mergeChainOf_##S(merge, first) ; c < merge->chains && merge->chainStarts[c] < last ; c++){ \
+        begin = merge->chainStarts[c]; \
+        end = merge->chainStarts[c + 1]; \
+        local = merge->cycles[c] && begin >= first && end <= last; \
+        if (local){ \
+            memcpy(mergeSaved_##S(merge, p, 2), mergeSlot_##S(merge, merge->chain[begin]), bytes); \
+        } \
+        /* the end of a chain that isn't a cycle only gives its block away */ \
+        stop = merge->cycles[c] ? end : end - 1; \
+        stop = (stop < last) ? stop : last; \
+        for (size_t i = (begin > first) ? begin : first ; i < stop ; i++){ \
+            if (i + 1 < end){ \
+                from = (i + 1 < last) ? mergeSlot_##S(merge, merge->chain[i + 1]) : mergeSaved_##S(merge, p + 1, 0); \
+            } \
+            else if (local){ \
+                from = mergeSaved_##S(merge, p, 2); \
+            } \
+            else{ \
+                for (head = p ; chunkStart(head, merge->segments, length) > begin ; head--); \
+                from = mergeSaved_##S(merge, head, 1); \
+            } \
+            memcpy(mergeSlot_##S(merge, merge->chain[i]), from, bytes); \
+        } \
+    } \
+} \
+\
+/* copies segment b's fragments into place, once the blocks around them have moved out */ \
+static inline void mergeFragments_##S(graph_merge_##S* merge, int b){ \
+    size_t first = chunkStart(b, merge->segments, merge->n); \
+    size_t last = chunkStart(b + 1, merge->segments, merge->n); \
+    size_t whole, after; \
+    mergeWhole_##S(merge, b, &whole, &after); \
+    memcpy(&merge->array[first], &merge->fragments[2 * b * merge->block], sizeof(T) * (whole - first)); \
+    memcpy(&merge->array[after], &merge->fragments[(2 * b + 1) * merge->block], sizeof(T) * (last - after)); \
+} \
+\
+static void parallelMergeJob_##S(int rank, void* arg){ \
+    parallel_merge_data_##S* data = (parallel_merge_data_##S *) arg; \
+    graph_merge_##S* merge = &data->merge; \
+    for (int g = rank ; g < merge->groupCount ; g += merge->segments){ \
+        mergeGroup_##S(merge, g); \
+    } \
+    if (merge->runs < 2){ \
+        return; \
+    } \
+    spinBarrierWait(&data->barrier, rank); \
+    if (rank > 0){ \
+        mergeSplit_##S(merge, rank); \
+    } \
+    /* nothing is written over until every split is found */ \
+    spinBarrierWait(&data->barrier, rank); \
+    mergeSegment_##S(merge, rank); \
+    spinBarrierWait(&data->barrier, rank); \
+    if (rank == 0){ \
+        mergePlan_##S(merge); \
+    } \
+    spinBarrierWait(&data->barrier, rank); \
+    mergeSave_##S(merge, rank); \
+    spinBarrierWait(&data->barrier, rank); \
+    mergeMove_##S(merge, rank); \
+    spinBarrierWait(&data->barrier, rank); \
+    mergeFragments_##S(merge, rank); \
+} \
+\
+static inline void graphMergeFree_##S(graph_merge_##S* merge){ \
+    free(merge->starts); \
+    free(merge->parts); \
+    free(merge->groups); \
+    free(merge->bounds); \
+    free(merge->left); \
+    free(merge->slots); \
+    free(merge->spare); \
+    free(merge->spareStarts); \
+    free(merge->fragments); \
+    free(merge->chain); \
+    free(merge->chainStarts); \
+    free(merge->cycles); \
+    free(merge->saved); \
+    free(merge->groupBuffer); \
+    free(merge->fronts); \
+    free(merge->has); \
+    free(merge->reading); \
+    free(merge->empty); \
+    free(merge->emptyStarts); \
+} \
+\
+static inline void parallelMerge_##S(worker_pool* pool, T* array, const size_t* starts, int runs){ \
+    parallel_merge_data_##S data; \
+    mergeSetup_##S(&data.merge, array, starts, runs, pool->thread_count); \
+    spinBarrierInit(&data.barrier, pool->thread_count); \
+    poolRun(pool, parallelMergeJob_##S, &data); \
+    spinBarrierDestroy(&data.barrier); \
+    graphMergeFree_##S(&data.merge); \
+} \
+\
+/* Task function: merges one group of short runs */ \
+static void graphMergeGroup_##S(void* arg){ \
+    graph_merge_part_##S* part = (graph_merge_part_##S *) arg; \
+    mergeGroup_##S(part->merge, part->index); \
+} \
+\
+/* Task function: co-ranks one split between segments */ \
+static void graphMergeSplit_##S(void* arg){ \
+    graph_merge_part_##S* part = (graph_merge_part_##S *) arg; \
+    mergeSplit_##S(part->merge, part->index); \
+} \
+\
+/* Task function: merges one segment into free blocks */ \
+static void graphMergeSegment_##S(void* arg){ \
+    graph_merge_part_##S* part = (graph_merge_part_##S *) arg; \
+    mergeSegment_##S(part->merge, part->index); \
+} \
+\
+/* Task function: lines up the chains of moves */ \
+static void graphMergePlan_##S(void* arg){ \
+    mergePlan_##S((graph_merge_##S *) arg); \
+} \
+\
+/* Task function: keeps the blocks one part of the moves writes over */ \
+static void graphMergeSave_##S(void* arg){ \
+    graph_merge_part_##S* part = (graph_merge_part_##S *) arg; \
+    mergeSave_##S(part->merge, part->index); \
+} \
+\
+/* Task function: one part of the moves */ \
+static void graphMergeMove_##S(void* arg){ \
+    graph_merge_part_##S* part = (graph_merge_part_##S *) arg; \
+    mergeMove_##S(part->merge, part->index); \
+} \
+\
+/* Task function: one segment's fragments */ \
+static void graphMergeFragments_##S(void* arg){ \
+    graph_merge_part_##S* part = (graph_merge_part_##S *) arg; \
+    mergeFragments_##S(part->merge, part->index); \
+} \
+\
+/* a join after one node per index (0 to count - 1), each after before */ \
+static inline task_node* graphMergeStep_##S(task_graph* graph, graph_merge_##S* merge, task_node* before, \
+        task_fn fn, int from, int count){ \
+    task_node* done = taskGraphNode(graph, NULL, NULL); \
+    task_node* node; \
+    taskGraphDepend(done, before); \
+    for (int i = from ; i < count ; i++){ \
+        node = taskGraphNode(graph, fn, &merge->parts[i]); \
+        taskGraphDepend(node, before); \
+        taskGraphDepend(done, node); \
+    } \
+    return done; \
+} \
+\
+static inline void graphMergeBuild_##S(task_graph* graph, graph_merge_##S* merge, task_node* after, \
+        T* array, const size_t* starts, int runs, int segments){ \
+    task_node* step; \
+    task_node* plan; \
+    mergeSetup_##S(merge, array, starts, runs, segments); \
+    for (int i = 0 ; i < runs + segments + 1 ; i++){ \
+        merge->parts[i].merge = merge; \
+        merge->parts[i].index = i; \
+    } \
+    step = after; \
+    if (merge->groupCount > 0){ \
+        step = graphMergeStep_##S(graph, merge, step, graphMergeGroup_##S, 0, merge->groupCount); \
+    } \
+    if (merge->runs < 2){ \
+        return; \
+    } \
+    /* nothing is written over until every split is found */ \
+    step = graphMergeStep_##S(graph, merge, step, graphMergeSplit_##S, 1, segments); \
+    step = graphMergeStep_##S(graph, merge, step, graphMergeSegment_##S, 0, segments); \
+    plan = taskGraphNode(graph, graphMergePlan_##S, merge); \
+    taskGraphDepend(plan, step); \
+    step = graphMergeStep_##S(graph, merge, plan, graphMergeSave_##S, 0, segments); \
+    step = graphMergeStep_##S(graph, merge, step, graphMergeMove_##S, 0, segments); \
+    graphMergeStep_##S(graph, merge, step, graphMergeFragments_##S, 0, segments); \
+}
+
+PARALLEL_MERGE_DEFINE(int32_t, i32)
+PARALLEL_MERGE_DEFINE(int64_t, i64)
+PARALLEL_MERGE_DEFINE(uint32_t, u32)
+PARALLEL_MERGE_DEFINE(uint64_t, u64)
+PARALLEL_MERGE_DEFINE(float, f32)
+PARALLEL_MERGE_DEFINE(double, f64)
+
+#endif
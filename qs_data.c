@@ -1,277 +1,555 @@
-/**
- * AUCSC 310/450
- * Combined Term Project
- * Quicksort
- * 
- * qs_data.c
- * 
- * Serial implementation of quicksort used for comparsion of 
- * parallel odd-even transposition sort with data level parallelism
- * 
- * Generates an array of ints into memory based on arguments from the command line. 
- * Then quicksort is used to serially sort the array
- * 
- * There is no data level parallelism here; this program is simply used to compare with 
- * odd-even transposition sort
- * 
- * The time to sort is recorded and printed to stdout
- * 
- * Methods:
- *  - main(int argc, const char* argv[]) -> int
- *      Creates a globally avaliable array and executes the sort serially
- *      or paralelly based on args (only serial is implemented)
- * 
- *  - partition (int* array, int low, int high) -> int
- *      High is the pivot, which is placed in the correct position of the array.
- *      Everything smaller is palce before it, and everything larger after it.
- *      Returns position index of pivot
- * 
- *  - quickSort(int* array, int low, int high) -> void
- *      Executes the sorting algorithm quicksort. Serial
- * 
- * - swap(int x, int y) -> void
- *      Swaps the elements at indices x and y in the global array
- * 
- *  - printArray(int* array, int size) -> void
- *      Prints an array on a single line
- * 
- *  - Usage(const char* prog_name) -> void
- *      Prints to stderr how to use the program
- * 
- * Resources:
- *  - https://www.geeksforgeeks.org/quick-sort/
- *      I pretty much copied their implementaion of quicksort. It's the same as
- *      was discussed in class, and I was more worried about implementing odd-even
- *      transposition sort
- * 
- * Started and completed November 13, 2019
- * 
- * Keegan Petreman (petreman@ualberta.ca)
- * 1528679
- */
-#include <stdio.h>
-#include <stdlib.h>
-#include <float.h>
-#include <time.h>
-#include <sys/time.h>
-#include <stdbool.h>
-#include <string.h>
-
-//set the upper bound for numbers generated
-#define MAX 1000
-
-//global variables  
-int* array;
-double elapsed = 0;
-
-//Function Prototypes
-int partition(int* array, int low, int high);
-void quickSort(int* array, int low, int high);
-void swap(int* array, int x, int y);
-void printArray(int* array, int size);
-void Usage(const char* prog_name); 
-
-/**
- * Preps the call to quicksort by checking the arguments for serial 
- * or parallel execution. Then randomly generates an array of the provided
- * size (if not provided, size 8 is default)
- * 
- * Parallel quicksort is not implemented, please use serial sort
- * 
- * @param argc: number of arguments given
- * @param argv[]: the arguments given
- * @return int
- */
-int main(int argc, const char* argv[]){ 
-    
-    int arraySize;
-    bool parallel = true;
-    struct timespec stop, start;
-
-    //check arguments
-    switch (argc){
-
-        case 1:
-            arraySize = 8;
-            break;
-
-        case 2:
-
-            if (strcmp(argv[1], "-s") == 0){
-                parallel = false;
-                arraySize = 8;
-            }//if
-
-            else{
-                //get size of array from command line
-                arraySize = strtol(argv[1], NULL, 10);
-            }//else
-
-            break;
-
-        case 3:
-            
-            if (strcmp(argv[1], "-s") == 0){
-                parallel = false;
-                arraySize = 8;
-            }//if
-
-            //get size of array from command line
-            arraySize = strtol(argv[2], NULL, 10);
-
-            break;      
-
-        default:
-            Usage(argv[0]);
-            return EXIT_SUCCESS;   
-
-    }//switch
-
-    array = malloc(sizeof(int) * arraySize);
-    
-    srand((unsigned) time(NULL));
-
-    //fill the array with random ints between 0 and MAX
-    for (int i = 0 ; i < arraySize ; i++){
-        array[i] =  (double)rand() / (double)(RAND_MAX / MAX);
-    }//for
-
-    if (parallel){
-        printf("Parallel quicksort not implemented, please use serial (\"-s\")\n");
-        free(array);
-        return EXIT_SUCCESS;
-
-        //leave this here for when parallel implemented
-        printf("\nParallel time on array of size %d:\n"
-            "%f seconds\n", arraySize, elapsed);
-
-    }//if
-
-    else{
-       
-        clock_gettime(CLOCK_MONOTONIC, &start);
-        quickSort(array, 0, arraySize-1); 
-        clock_gettime(CLOCK_MONOTONIC, &stop);
-
-        elapsed = (stop.tv_sec - start.tv_sec);
-        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
-
-        printf("\nSerial time on array of size %d:\n"
-            "%f seconds\n", arraySize, elapsed);
-
-    }//else
-
-    free(array); 
-    
-    return EXIT_SUCCESS;
-
-}//main
-
-/**
- * Takes the last element of an array as the pivot, places 
- * the pivot element at its correct position in sorted 
- * array, and places all smaller (smaller than pivot) 
- * to left of pivot and all greater elements to right 
- * of pivot 
- * 
- * From https://www.geeksforgeeks.org/quick-sort/
- * 
- * @param array: the array to be partitioned
- * @param low: starting index into array for partition
- * @param high: ending index into array for partition
- */
-int partition (int* array, int low, int high){ 
-    
-    int pivot = array[high];    // pivot
-    int i = (low - 1);  // Index of smaller element 
-  
-    for (int j = low; j <= high - 1; j++){ 
-        // If current element is smaller than the pivot 
-        if (array[j] < pivot){ 
-            i++;    // increment index of smaller element 
-            swap(array, i, j); 
-        }//if
-
-    }//for 
-
-    swap(array, i + 1, high); 
-    return (i + 1); 
-
-}//partition 
-  
-/**
- * The main function that implements QuickSort through 
- * recursive calls and use of partition()
- * 
- * From https://www.geeksforgeeks.org/quick-sort/
- * 
- * @param array: Array to be sorted
- * @param low: Starting index
- * @param high: Ending index 
- * @return void
- */
-void quickSort(int* array, int low, int high){ 
-    
-    if (low < high){ 
-        
-        //pi is partitioning index, array[p] is now at right place
-        int pi = partition(array, low, high); 
-  
-        //Separately sort elements before and after the partition
-        quickSort(array, low, pi - 1); 
-        quickSort(array, pi + 1, high); 
-
-    }//if
-
-}//quicksort 
-
-/**
- * Swaps the two elements located at the provided indices of the array.
- * The array to be sorted is assumed to be of double precision numbers
- * 
- * @param array: pointer to the array of ints where the swap is to occur
- * @param x: first indice of array that needs to be swapped
- * @param y: second indice of array that needs to be swapped
- * @return void
- */ 
-void swap(int* array, int x, int y) {
-   
-   int temp;
-   temp = array[x];
-   array[x] = array[y];
-   array[y] = temp;
-
-}//swap
-
-/**
- * Prints an array to stdout on a single line
- * 
- * Used in an eariler implementation
- * 
- * @param array: pointer to the array to print
- * @param size: the size of the array tp print
- * @return void
- */
-void printArray(int* array, int size){
-
-    for (int i = 0 ; i < size ; i++){
-        printf ("%d ", array[i]);
-    }//for
-
-    printf("\n");
-
-}//printArray
-
-/**
- * Displays how to use the program.
- * I saw that Peter Pacheco used a similar function for his programs,
- * so I thought I'd add one for mine
- * 
- * @param prog_name: name of the program
- * @return void
- */
-void Usage(const char* prog_name){
-   fprintf(stderr, "usage:   %s <-s> <n>\n", prog_name);
-   fprintf(stderr, "  's':  run serial quicksort sort\n");
-   fprintf(stderr, "   n:   number of elements in list\n");
-}//Usage
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Quicksort
+ * 
+ * qs_data.c
+ * 
+ * Serial and parallel implementation of quicksort used for comparsion of 
+ * parallel odd-even transposition sort with data level parallelism
+ * 
+ * Generates an array of ints into memory based on arguments from the command line. 
+ * Then quicksort is used to serially or parallelly sort the array
+ * 
+ * The parallel sort runs on a work-stealing pool (task_pool.h). Every partition
+ * spawns its smaller side as a task that any idle thread can steal, and keeps
+ * going on the larger side itself. Ranges under SPAWN_CUTOFF are sorted by one
+ * thread with the serial quickSort. Like introsort, every range carries how many
+ * more partitions it may take (introSortDepth), and once that runs out it is
+ * heapsorted, so bad pivots can't make the parallel levels quadratic. The top levels, where a single partition is
+ * too big for one thread, are partitioned in parallel: every thread counts and
+ * then scatters its own block of the range into scratch
+ * 
+ * The key type comes from sort_core.h and defaults to 32 bit ints. Compile with
+ * -DSORT_KEY=i64, u32, u64, f32 or f64 to sort a different type
+ * 
+ * The time to sort is recorded and printed to stdout
+ * 
+ * Methods:
+ *  - main(int argc, const char* argv[]) -> int
+ *      Creates a globally avaliable array and executes the sort serially
+ *      or paralelly based on args
+ * 
+ *  - parallelQuickSort(size_t arraySize) -> void
+ *      Sorts the global array on the task pool
+ * 
+ *  - quickSortRoot(void* arg) -> void
+ *      Task function
+ *      Sorts the whole array and waits for every task it spawned
+ * 
+ *  - quickSortTask(void* arg) -> void
+ *      Task function
+ *      Sorts the range it was given (spawning more tasks as it goes)
+ * 
+ *  - quickSortRange(size_t low, size_t high, int depth) -> void
+ *      Partitions array[low, high) until it is short enough to sort serially,
+ *      or heapsorts it once depth partitions have been spent
+ * 
+ *  - parallelPartition(size_t low, size_t high, elem_t pivot, size_t* lt, size_t* gt) -> void
+ *      Three-way partition of array[low, high) by all the threads
+ * 
+ *  - countBlock, scatterBlock, copyBlock (void* arg) -> void
+ *      Task functions
+ *      The three steps of a parallel partition, on one block of the range
+ * 
+ *  - quickSort, heapSort, introSortDepth, partition3, choosePivot, swap and printArray
+ *    come from sort_core.h
+ *      (quickSort executes the sorting algorithm quicksort as an introsort. Serial)
+ * 
+ *  - Usage(const char* prog_name) -> void
+ *      Prints to stderr how to use the program
+ * 
+ * Resources:
+ *  - https://www.geeksforgeeks.org/quick-sort/
+ *      I pretty much copied their implementaion of quicksort. It's the same as
+ *      was discussed in class, and I was more worried about implementing odd-even
+ *      transposition sort
+ * 
+ * Started and completed November 13, 2019
+ * 
+ * Keegan Petreman (petreman@ualberta.ca)
+ * 1528679
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <time.h>
+#include <sys/time.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef SORT_KEY
+#define SORT_KEY i32
+#endif
+#include "sort_core.h"
+#include "worker_pool.h"
+#include "task_pool.h"
+#include "random_fill.h"
+
+//set the upper bound for numbers generated
+#define MAX 1000
+
+#define SPAWN_CUTOFF 16384 //ranges shorter than this are sorted by the thread that made them
+#define PARALLEL_PARTITION_CUTOFF 262144 //ranges this long are partitioned by all the threads
+#define MIN_BLOCK 65536 //fewest elements a thread gets in a parallel partition
+
+//a range of the array for a task to sort, [low, high)
+typedef struct {
+    size_t low;
+    size_t high;
+    int depth; //partitions left before it is heapsorted
+} sort_range;
+
+//one thread's block of a parallel partition
+typedef struct {
+    size_t start;
+    size_t end;
+    elem_t pivot;
+    size_t counts[3]; //less than, equal to and greater than the pivot
+    size_t offsets[3]; //where each of those goes in scratch
+} partition_block;
+
+//global variables  
+elem_t* array;
+elem_t* scratch;
+double elapsed = 0;
+int thread_count;
+task_pool tasks;
+task_group sortGroup;
+
+//Function Prototypes
+void Usage(const char* prog_name); 
+void parallelQuickSort(size_t arraySize);
+void quickSortRoot(void* arg);
+void quickSortTask(void* arg);
+void quickSortRange(size_t low, size_t high, int depth);
+void parallelPartition(size_t low, size_t high, elem_t pivot, size_t* lt, size_t* gt);
+void countBlock(void* arg);
+void scatterBlock(void* arg);
+void copyBlock(void* arg);
+
+/**
+ * Preps the call to quicksort by checking the arguments for serial 
+ * or parallel execution. Then randomly generates an array of the provided
+ * size (if not provided, size 8 is default). Parallel sorts use 2 threads
+ * unless told otherwise
+ * 
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given
+ * @return int
+ */
+int main(int argc, const char* argv[]){ 
+    
+    size_t arraySize;
+    bool parallel = true;
+    uint64_t seed;
+    worker_pool fillers; //only used to make the array
+    struct timespec stop, start;
+
+    //--seed can go anywhere, the rest are checked by position
+    argc = randomSeedOption(argc, argv, &seed);
+
+    //check arguments
+    switch (argc){
+
+        case 1:
+            arraySize = 8;
+            thread_count = 2;
+            break;
+
+        case 2:
+
+            if (strcmp(argv[1], "-s") == 0){
+                parallel = false;
+                arraySize = 8;
+                thread_count = 1;
+            }//if
+
+            else{
+                //get size of array from command line
+                arraySize = strtoull(argv[1], NULL, 10);
+                thread_count = 2;
+            }//else
+
+            break;
+
+        case 3:
+            
+            if (strcmp(argv[1], "-s") == 0){
+                parallel = false;
+                arraySize = strtoull(argv[2], NULL, 10);
+                thread_count = 1;
+            }//if
+
+            else{
+                //get size of array from command line
+                arraySize = strtoull(argv[1], NULL, 10);
+                thread_count = strtol(argv[2], NULL, 10);
+            }//else
+
+            break;      
+
+        default:
+            Usage(argv[0]);
+            return EXIT_SUCCESS;   
+
+    }//switch
+
+    if (thread_count < 1){
+        Usage(argv[0]);
+        return EXIT_SUCCESS;
+    }//if
+
+    array = malloc(sizeof(elem_t) * arraySize);
+
+    if (array == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", arraySize);
+        return EXIT_FAILURE;
+    }//if
+    
+    //fill the array with random numbers between 0 and MAX, the same ones for the same seed
+    poolInit(&fillers, thread_count);
+    SORT(randomFill)(&fillers, array, arraySize, MAX, seed);
+    poolDestroy(&fillers);
+    printf("Seed %llu\n", (unsigned long long) seed);
+
+    if (parallel){
+
+        //threads are created before timing starts, like oets_data.c
+        taskPoolInit(&tasks, thread_count);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        parallelQuickSort(arraySize);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        taskPoolDestroy(&tasks);
+
+        elapsed = (stop.tv_sec - start.tv_sec);
+        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        printf("\nParallel time on array of size %zu (%d threads):\n"
+            "%f seconds\n", arraySize, thread_count, elapsed);
+
+    }//if
+
+    else{
+       
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        SORT(quickSort)(array, 0, (ptrdiff_t) arraySize - 1);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        elapsed = (stop.tv_sec - start.tv_sec);
+        elapsed += (stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+        printf("\nSerial time on array of size %zu:\n"
+            "%f seconds\n", arraySize, elapsed);
+
+    }//else
+
+    free(array); 
+    
+    return EXIT_SUCCESS;
+
+}//main
+
+/**
+ * Sorts the global array with quicksort on the task pool, using a scratch
+ * array for the parallel partitions
+ * 
+ * @param arraySize: number of elements in the array
+ * @return void
+ */
+void parallelQuickSort(size_t arraySize){
+
+    sort_range whole = {0, arraySize, introSortDepth(arraySize)};
+
+    scratch = malloc(sizeof(elem_t) * arraySize);
+
+    if (scratch == NULL){
+        fprintf(stderr, "Couldn't allocate memory for %zu numbers\n", arraySize);
+        exit(EXIT_FAILURE);
+    }//if
+
+    atomic_init(&sortGroup.pending, 0);
+    taskPoolRun(&tasks, quickSortRoot, &whole);
+
+    free(scratch);
+
+}//parallelQuickSort
+
+/**
+ * Task Function
+ * 
+ * Runs on the main thread: sorts the whole array, then helps with the tasks
+ * that were spawned along the way until they are all done
+ * 
+ * @param *arg: the range to sort
+ * @return void
+ */
+void quickSortRoot(void* arg){
+
+    sort_range* range = (sort_range *) arg;
+
+    quickSortRange(range->low, range->high, range->depth);
+    taskGroupWait(&tasks, &sortGroup);
+
+}//quickSortRoot
+
+/**
+ * Task Function
+ * 
+ * Sorts the range it was spawned with. Quicksort doesn't need to join
+ * its halves, so nobody waits on this task except through sortGroup
+ * 
+ * @param *arg: the range to sort, freed here
+ * @return void
+ */
+void quickSortTask(void* arg){
+
+    sort_range range = *(sort_range *) arg;
+
+    free(arg);
+    quickSortRange(range.low, range.high, range.depth);
+
+}//quickSortTask
+
+/**
+ * Three-way partitions array[low, high) until what's left is short enough
+ * to sort serially. Each time, the smaller side is given away as a task (or
+ * sorted right here if it's too short to be worth it) and the larger side
+ * is partitioned next, so no thread ever holds more than log n pending ranges.
+ * Both sides go on with one partition less; a range that has none left is
+ * heapsorted by this thread, as introsort does
+ * 
+ * @param low: first index of the range
+ * @param high: one past the last index of the range
+ * @param depth: partitions the range may still take
+ * @return void
+ */
+void quickSortRange(size_t low, size_t high, int depth){
+
+    size_t lt, gt;
+    size_t smallLow, smallHigh;
+    elem_t pivot;
+    sort_range* task;
+
+    while (high - low > SPAWN_CUTOFF){
+
+        //too many bad pivots, quicksort is heading for n^2
+        if (depth-- == 0){
+            SORT(heapSort)(&array[low], high - low);
+            return;
+        }//if
+
+        pivot = SORT(choosePivot)(&array[low], high - low);
+
+        if (high - low >= PARALLEL_PARTITION_CUTOFF && thread_count > 1){
+            parallelPartition(low, high, pivot, &lt, &gt);
+        }//if
+
+        else{
+            SORT(partition3)(&array[low], high - low, pivot, &lt, &gt);
+            lt += low;
+            gt += low;
+        }//else
+
+        //everything equal to the pivot is already in place
+        if (lt - low < high - gt){
+            smallLow = low;
+            smallHigh = lt;
+            low = gt;
+        }//if
+
+        else{
+            smallLow = gt;
+            smallHigh = high;
+            high = lt;
+        }//else
+
+        if (smallHigh - smallLow <= SPAWN_CUTOFF){
+            SORT(quickSort)(array, (ptrdiff_t) smallLow, (ptrdiff_t) smallHigh - 1);
+        }//if
+
+        else{
+
+            task = (sort_range *) malloc(sizeof(sort_range));
+
+            if (task == NULL){
+                fprintf(stderr, "Couldn't allocate memory for a task\n");
+                exit(EXIT_FAILURE);
+            }//if
+
+            task->low = smallLow;
+            task->high = smallHigh;
+            task->depth = depth;
+            taskSpawn(&tasks, &sortGroup, quickSortTask, task);
+
+        }//else
+
+    }//while
+
+    if (high - low > 1){
+        SORT(quickSort)(array, (ptrdiff_t) low, (ptrdiff_t) high - 1);
+    }//if
+
+}//quickSortRange
+
+/**
+ * Three-way partition of array[low, high) around pivot, split among the threads.
+ * Each block counts how many of its elements are less than, equal to and greater
+ * than the pivot. A prefix sum over the blocks tells each one where its elements
+ * go, so they can all scatter into scratch at once without overlapping, and then
+ * copy the result back
+ * 
+ * @param low: first index of the range
+ * @param high: one past the last index of the range
+ * @param pivot: value to partition around
+ * @param lt: set to the first index equal to the pivot
+ * @param gt: set to the first index greater than the pivot
+ * @return void
+ */
+void parallelPartition(size_t low, size_t high, elem_t pivot, size_t* lt, size_t* gt){
+
+    size_t n = high - low;
+    int blocks = thread_count;
+    size_t total[3] = {0, 0, 0};
+    size_t base[3];
+    partition_block* block;
+    task_group phase;
+
+    if (n / blocks < MIN_BLOCK){
+        blocks = (int) (n / MIN_BLOCK) + 1;
+    }//if
+
+    block = (partition_block *) malloc(sizeof(partition_block) * blocks);
+
+    if (block == NULL){
+        fprintf(stderr, "Couldn't allocate memory for a partition\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    for (int b = 0 ; b < blocks ; b++){
+        block[b].start = low + chunkStart(b, blocks, n);
+        block[b].end = low + chunkStart(b + 1, blocks, n);
+        block[b].pivot = pivot;
+    }//for
+
+    atomic_init(&phase.pending, 0);
+
+    for (int b = 0 ; b < blocks ; b++){
+        taskSpawn(&tasks, &phase, countBlock, &block[b]);
+    }//for
+
+    taskGroupWait(&tasks, &phase);
+
+    for (int b = 0 ; b < blocks ; b++){
+        for (int k = 0 ; k < 3 ; k++){
+            block[b].offsets[k] = total[k];
+            total[k] += block[b].counts[k];
+        }//for
+    }//for
+
+    base[0] = low;
+    base[1] = low + total[0];
+    base[2] = base[1] + total[1];
+
+    for (int b = 0 ; b < blocks ; b++){
+        for (int k = 0 ; k < 3 ; k++){
+            block[b].offsets[k] += base[k];
+        }//for
+        taskSpawn(&tasks, &phase, scatterBlock, &block[b]);
+    }//for
+
+    taskGroupWait(&tasks, &phase);
+
+    for (int b = 0 ; b < blocks ; b++){
+        taskSpawn(&tasks, &phase, copyBlock, &block[b]);
+    }//for
+
+    taskGroupWait(&tasks, &phase);
+
+    *lt = base[1];
+    *gt = base[2];
+
+    free(block);
+
+}//parallelPartition
+
+/**
+ * Task Function
+ * 
+ * Counts the elements of a block that are less than, equal to
+ * and greater than the pivot
+ * 
+ * @param *arg: the block
+ * @return void
+ */
+void countBlock(void* arg){
+
+    partition_block* block = (partition_block *) arg;
+    size_t less = 0, equal = 0;
+
+    for (size_t i = block->start ; i < block->end ; i++){
+        less += array[i] < block->pivot;
+        equal += !(array[i] < block->pivot) && !(block->pivot < array[i]);
+    }//for
+
+    block->counts[0] = less;
+    block->counts[1] = equal;
+    block->counts[2] = (block->end - block->start) - less - equal;
+
+}//countBlock
+
+/**
+ * Task Function
+ * 
+ * Writes each element of a block to its place in scratch
+ * 
+ * @param *arg: the block, with its offsets filled in
+ * @return void
+ */
+void scatterBlock(void* arg){
+
+    partition_block* block = (partition_block *) arg;
+    size_t next[3] = {block->offsets[0], block->offsets[1], block->offsets[2]};
+    int k;
+
+    for (size_t i = block->start ; i < block->end ; i++){
+        k = (array[i] < block->pivot) ? 0 : ((block->pivot < array[i]) ? 2 : 1);
+        scratch[next[k]++] = array[i];
+    }//for
+
+}//scatterBlock
+
+/**
+ * Task Function
+ * 
+ * Copies a block's range of the partitioned scratch back into the array
+ * 
+ * @param *arg: the block
+ * @return void
+ */
+void copyBlock(void* arg){
+
+    partition_block* block = (partition_block *) arg;
+
+    memcpy(&array[block->start], &scratch[block->start],
+        sizeof(elem_t) * (block->end - block->start));
+
+}//copyBlock
+
+/**
+ * Displays how to use the program.
+ * I saw that Peter Pacheco used a similar function for his programs,
+ * so I thought I'd add one for mine
+ * 
+ * @param prog_name: name of the program
+ * @return void
+ */
+void Usage(const char* prog_name){
+   fprintf(stderr, "usage:   %s <-s> <n> <t> <--seed x>\n", prog_name);
+   fprintf(stderr, "  's':  run serial quicksort sort\n");
+   fprintf(stderr, "   n:   number of elements in list\n");
+   fprintf(stderr, "   t:   number of threads to use\n");
+   fprintf(stderr, "   x:   seed for the random numbers, the same seed sorts the same array\n");
+}//Usage
@@ -0,0 +1,213 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Radix Sort
+ *
+ * radix_sort.h
+ *
+ * Parallel LSD radix sort for 32 and 64 bit integer keys, run on worker_pool.h
+ *
+ * Keys are sorted one 8 bit digit at a time, lowest digit first. Every thread
+ * owns one chunk of the array (chunkStart) and, for each digit, counts how many
+ * of its keys fall in each of the 256 buckets. Those counts are prefix-summed
+ * (bucket by bucket, then thread by thread inside a bucket) so every thread knows
+ * exactly where each of its keys goes, and all threads scatter into the other
+ * buffer at once without any locking. Thread order inside a bucket is chunk
+ * order, so every pass is stable.
+ *
+ * Scattering to 256 places at once touches 256 cache lines per key written, so
+ * keys are first collected in a small per-thread buffer for each bucket and copied
+ * out a full cache line at a time (software write-combining).
+ *
+ * Before sorting, every digit of every key is counted in one read of the array.
+ * A digit that is the same for every key (all the high bytes of small numbers)
+ * puts everything in one bucket and would just copy the array, so it is skipped.
+ *
+ * Signed keys have their sign bit flipped when digits are taken out of them,
+ * so negative numbers land in the lower buckets.
+ *
+ * Methods (one of each per type, T is the key type):
+ *  - radixSort_<type>(worker_pool* pool, T* array, T* scratch, size_t n) -> void
+ *      Sorts array (scratch must hold n keys) with every thread of the pool
+ *
+ *  - radixJob_<type>(int rank, void* arg) -> void
+ *      Pool job, what every thread runs for one sort
+ *
+ *  - radixCount_<type>(const T* keys, size_t n, int shift, size_t* counts) -> void
+ *      Adds up how many keys have each value of one digit
+ *
+ *  - radixScatter_<type>(const T* from, T* to, size_t start, size_t end,
+ *          int shift, size_t* offsets, T* buffer) -> void
+ *      Moves keys [start, end) to their place for one digit, through the write-combining buffers
+ *
+ * Resources:
+ *  - Satish, Harris and Garland, "Designing Efficient Sorting Algorithms for
+ *    Manycore GPUs" and Polychroniou and Ross, "A Comprehensive Study of
+ *    Main-Memory Partitioning and its Application to Large-Scale Comparison-
+ *    and Radix-Sort" (SIGMOD 2014)
+ *      per-thread histograms and buffered scatter
+ */
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "worker_pool.h"
+#include "spin_barrier.h"
+
+#define RADIX_BITS 8 //bits per digit
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MAX_PASSES 8 //64 bit keys
+
+//which key types radix sort can handle, for checking SORT_KEY with #if
+#define RADIX_KEY_i32 1
+#define RADIX_KEY_i64 1
+#define RADIX_KEY_u32 1
+#define RADIX_KEY_u64 1
+
+#define RADIX_DEFINE(T, U, S, SIGN) \
+\
+/* shared by every thread of one sort */ \
+typedef struct { \
+    T* array; \
+    T* scratch; \
+    size_t n; \
+    int thread_count; \
+    size_t* counts; /* [thread][pass][bucket] */ \
+    spin_barrier barrier; \
+} radix_sort_data_##S; \
+\
+/* keys per write-combining buffer: one cache line */ \
+enum { RADIX_LINE_##S = CACHE_LINE / sizeof(T) }; \
+\
+static inline unsigned radixDigit_##S(T key, int shift){ \
+    return (unsigned) ((((U) key) ^ (SIGN)) >> shift) & (RADIX_BUCKETS - 1); \
+} \
+\
+static inline void radixCount_##S(const T* keys, size_t n, int shift, size_t* counts){ \
+    memset(counts, 0, sizeof(size_t) * RADIX_BUCKETS); \
+    for (size_t i = 0 ; i < n ; i++){ \
+        counts[radixDigit_##S(keys[i], shift)]++; \
+    } \
+} \
+\
+static inline void radixScatter_##S(const T* from, T* to, size_t start, size_t end, \
+        int shift, size_t* offsets, T* buffer){ \
+    unsigned fill[RADIX_BUCKETS] = {0}; \
+    unsigned b; \
+    for (size_t i = start ; i < end ; i++){ \
+        b = radixDigit_##S(from[i], shift); \
+        buffer[b * RADIX_LINE_##S + fill[b]++] = from[i]; \
+        if (fill[b] == RADIX_LINE_##S){ \
+            memcpy(&to[offsets[b]], &buffer[b * RADIX_LINE_##S], CACHE_LINE); \
+            offsets[b] += RADIX_LINE_##S; \
+            fill[b] = 0; \
+        } \
+    } \
+    /* whatever is left over in the buffers */ \
+    for (b = 0 ; b < RADIX_BUCKETS ; b++){ \
+        memcpy(&to[offsets[b]], &buffer[b * RADIX_LINE_##S], sizeof(T) * fill[b]); \
+        offsets[b] += fill[b]; \
+    } \
+} \
+\
+static void radixJob_##S(int rank, void* arg){ \
+    radix_sort_data_##S* data = (radix_sort_data_##S *) arg; \
+    int p = data->thread_count; \
+    int passes = (int) sizeof(T); \
+    size_t myStart = chunkStart(rank, p, data->n); \
+    size_t myEnd = chunkStart(rank + 1, p, data->n); \
+    size_t* counts = data->counts; \
+    size_t* mine = &counts[(size_t) rank * RADIX_MAX_PASSES * RADIX_BUCKETS]; \
+    size_t offsets[RADIX_BUCKETS]; \
+    size_t total, sum; \
+    bool skip[RADIX_MAX_PASSES]; \
+    bool counted = true; /* counts for the next pass are still valid */ \
+    T* from = data->array; \
+    T* to = data->scratch; \
+    T* temp; \
+    T* buffer = aligned_alloc(CACHE_LINE, sizeof(T) * RADIX_LINE_##S * RADIX_BUCKETS); \
+    if (buffer == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the radix buffers\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    /* every digit of my chunk in one read */ \
+    memset(mine, 0, sizeof(size_t) * RADIX_MAX_PASSES * RADIX_BUCKETS); \
+    for (size_t i = myStart ; i < myEnd ; i++){ \
+        U key = ((U) from[i]) ^ (SIGN); \
+        for (int d = 0 ; d < passes ; d++){ \
+            mine[d * RADIX_BUCKETS + ((key >> (d * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++; \
+        } \
+    } \
+    spinBarrierWait(&data->barrier, rank); \
+    /* a digit with one bucket holding every key doesn't move anything */ \
+    for (int d = 0 ; d < passes ; d++){ \
+        skip[d] = false; \
+        for (int b = 0 ; b < RADIX_BUCKETS && !skip[d] ; b++){ \
+            total = 0; \
+            for (int t = 0 ; t < p ; t++){ \
+                total += counts[((size_t) t * RADIX_MAX_PASSES + d) * RADIX_BUCKETS + b]; \
+            } \
+            skip[d] = (total == data->n); \
+        } \
+    } \
+    for (int d = 0 ; d < passes ; d++){ \
+        if (skip[d]){ \
+            continue; \
+        } \
+        /* keys moved between chunks since the first count */ \
+        if (!counted){ \
+            radixCount_##S(&from[myStart], myEnd - myStart, d * RADIX_BITS, \
+                &mine[d * RADIX_BUCKETS]); \
+            spinBarrierWait(&data->barrier, rank); \
+        } \
+        counted = false; \
+        /* my keys for bucket b go after every key in smaller buckets \
+           and after the bucket b keys of lower ranks */ \
+        sum = 0; \
+        for (int b = 0 ; b < RADIX_BUCKETS ; b++){ \
+            offsets[b] = sum; \
+            for (int t = 0 ; t < p ; t++){ \
+                size_t c = counts[((size_t) t * RADIX_MAX_PASSES + d) * RADIX_BUCKETS + b]; \
+                offsets[b] += (t < rank) ? c : 0; \
+                sum += c; \
+            } \
+        } \
+        radixScatter_##S(from, to, myStart, myEnd, d * RADIX_BITS, offsets, buffer); \
+        spinBarrierWait(&data->barrier, rank); \
+        temp = from; \
+        from = to; \
+        to = temp; \
+    } \
+    if (from != data->array){ \
+        memcpy(&data->array[myStart], &from[myStart], sizeof(T) * (myEnd - myStart)); \
+    } \
+    free(buffer); \
+} \
+\
+static inline void radixSort_##S(worker_pool* pool, T* array, T* scratch, size_t n){ \
+    radix_sort_data_##S data; \
+    data.array = array; \
+    data.scratch = scratch; \
+    data.n = n; \
+    data.thread_count = pool->thread_count; \
+    data.counts = malloc(sizeof(size_t) * pool->thread_count * RADIX_MAX_PASSES * RADIX_BUCKETS); \
+    if (data.counts == NULL){ \
+        fprintf(stderr, "Couldn't allocate memory for the radix counts\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    spinBarrierInit(&data.barrier, pool->thread_count); \
+    poolRun(pool, radixJob_##S, &data); \
+    spinBarrierDestroy(&data.barrier); \
+    free(data.counts); \
+}
+
+RADIX_DEFINE(int32_t, uint32_t, i32, UINT32_C(0x80000000))
+RADIX_DEFINE(int64_t, uint64_t, i64, UINT64_C(0x8000000000000000))
+RADIX_DEFINE(uint32_t, uint32_t, u32, 0)
+RADIX_DEFINE(uint64_t, uint64_t, u64, 0)
+
+#endif
@@ -0,0 +1,243 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Random Numbers
+ *
+ * random_fill.h
+ *
+ * Fast, repeatable random input for the sorting programs, generated in parallel
+ * on worker_pool.h
+ *
+ * rand() keeps one hidden state behind a lock, so it can't be shared by threads,
+ * and seeding it with time(NULL) means no two runs sort the same numbers. Here
+ * every block of RANDOM_BLOCK numbers gets its own xoshiro256** generator, seeded
+ * from the run's seed and the block's index alone. Threads split the blocks
+ * between them, and since block b always gets the same numbers, the output only
+ * depends on the seed: not on how many threads made it, or in what order
+ *
+ * Seeds (and the four words of generator state) are spread out with splitmix64,
+ * so neighbouring block numbers still give unrelated streams
+ *
+ * Methods:
+ *  - rngMix(uint64_t x) -> uint64_t
+ *      splitmix64 finaliser, scrambles a number into a well mixed one
+ *
+ *  - randomStream(uint64_t seed, uint64_t stream) -> uint64_t
+ *      Seed of stream number stream of seed (a block, or a file)
+ *
+ *  - rngSeed(rng_state* rng, uint64_t seed) -> void
+ *      Sets up a generator from a seed
+ *
+ *  - rngNext(rng_state* rng) -> uint64_t
+ *      Next 64 random bits (xoshiro256**)
+ *
+ *  - rngDouble(rng_state* rng) -> double
+ *      Random double in [0, 1)
+ *
+ *  - randomSeedOption(int argc, const char* argv[], uint64_t* seed) -> int
+ *      Takes "--seed n" (or "--seed=n") out of the arguments, returns the new argc.
+ *      Without one, seed is made from the clock. A --seed without a number is a
+ *      usage error, the program exits
+ *
+ *  - randomFill_<type>(worker_pool* pool, T* array, size_t n, double max, uint64_t seed) -> void
+ *      Fills array with n random numbers in [0, max) with every thread of the pool
+ *
+ *  - randomJob_<type>(int rank, void* arg) -> void
+ *      Pool job, fills one thread's share of the blocks
+ *
+ * Resources:
+ *  - Blackman and Vigna, "Scrambled Linear Pseudorandom Number Generators" (2021)
+ *      xoshiro256** and seeding it with splitmix64
+ */
+#ifndef RANDOM_FILL_H
+#define RANDOM_FILL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "worker_pool.h"
+
+#define RANDOM_BLOCK 65536 //numbers made by one generator
+
+typedef struct {
+    uint64_t s[4];
+} rng_state;
+
+/**
+ * @param x: any number
+ * @return uint64_t: x scrambled (splitmix64's output function)
+ */
+static inline uint64_t rngMix(uint64_t x){
+
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+
+    return x ^ (x >> 31);
+
+}//rngMix
+
+/**
+ * @param seed: the run's seed
+ * @param stream: which stream (block or file number)
+ * @return uint64_t: a seed of its own for that stream
+ */
+static inline uint64_t randomStream(uint64_t seed, uint64_t stream){
+    return rngMix(seed ^ rngMix(stream));
+}//randomStream
+
+/**
+ * @param rng: generator to set up
+ * @param seed: where it starts
+ * @return void
+ */
+static inline void rngSeed(rng_state* rng, uint64_t seed){
+
+    //consecutive splitmix64 outputs, never all zero
+    for (int i = 0 ; i < 4 ; i++){
+        rng->s[i] = rngMix(seed + (uint64_t) i * 0x9E3779B97F4A7C15ull);
+    }//for
+
+}//rngSeed
+
+/**
+ * @param rng: the generator
+ * @return uint64_t: next 64 random bits
+ */
+static inline uint64_t rngNext(rng_state* rng){
+
+    uint64_t* s = rng->s;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+
+    return result;
+
+}//rngNext
+
+/**
+ * @param rng: the generator
+ * @return double: random in [0, 1), from the top 53 bits
+ */
+static inline double rngDouble(rng_state* rng){
+    return (double) (rngNext(rng) >> 11) * 0x1.0p-53;
+}//rngDouble
+
+/**
+ * Looks for "--seed n" or "--seed=n" among the arguments and removes it, so the
+ * program can check the rest of its arguments like before. A --seed at the end, or
+ * with something that isn't a number, is reported and the program exits instead of
+ * the rest being taken as a file or a count
+ *
+ * @param argc: number of arguments given
+ * @param argv[]: the arguments given, the seed option is taken out
+ * @param seed: set to the seed given, or one made from the clock
+ * @return int: argc without the seed option
+ */
+static inline int randomSeedOption(int argc, const char* argv[], uint64_t* seed){
+
+    struct timespec now;
+    const char* value = NULL;
+    char* end;
+    int kept = 1;
+
+    for (int i = 1 ; i < argc ; i++){
+
+        if (strcmp(argv[i], "--seed") == 0){
+
+            if (i + 1 == argc){
+                fprintf(stderr, "usage:   %s ... --seed x, x is missing\n", argv[0]);
+                exit(EXIT_FAILURE);
+            }//if
+
+            value = argv[++i];
+
+        }//if
+
+        else if (strncmp(argv[i], "--seed=", 7) == 0){
+            value = argv[i] + 7;
+        }//else if
+
+        else{
+            argv[kept++] = argv[i];
+        }//else
+
+    }//for
+
+    if (value != NULL){
+
+        *seed = strtoull(value, &end, 10);
+
+        if (end == value || *end != '\0'){
+            fprintf(stderr, "usage:   %s ... --seed x, x has to be a number, not \"%s\"\n", argv[0], value);
+            exit(EXIT_FAILURE);
+        }//if
+
+    }//if
+
+    else{
+        clock_gettime(CLOCK_REALTIME, &now);
+        *seed = rngMix((uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec);
+    }//else
+
+    argv[kept] = NULL;
+
+    return kept;
+
+}//randomSeedOption
+
+#define RANDOM_FILL_DEFINE(T, S) \
+\
+/* shared by every thread of one fill */ \
+typedef struct { \
+    T* array; \
+    size_t n; \
+    double max; \
+    uint64_t seed; \
+    int thread_count; \
+} random_fill_data_##S; \
+\
+static void randomJob_##S(int rank, void* arg){ \
+    random_fill_data_##S* data = (random_fill_data_##S *) arg; \
+    size_t blocks = (data->n + RANDOM_BLOCK - 1) / RANDOM_BLOCK; \
+    size_t first = chunkStart(rank, data->thread_count, blocks); \
+    size_t last = chunkStart(rank + 1, data->thread_count, blocks); \
+    rng_state rng; \
+    for (size_t b = first ; b < last ; b++){ \
+        size_t start = b * RANDOM_BLOCK; \
+        size_t end = (start + RANDOM_BLOCK < data->n) ? start + RANDOM_BLOCK : data->n; \
+        rngSeed(&rng, randomStream(data->seed, b)); \
+        for (size_t i = start ; i < end ; i++){ \
+            data->array[i] = (T) (rngDouble(&rng) * data->max); \
+        } \
+    } \
+} \
+\
+static inline void randomFill_##S(worker_pool* pool, T* array, size_t n, double max, uint64_t seed){ \
+    random_fill_data_##S data; \
+    data.array = array; \
+    data.n = n; \
+    data.max = max; \
+    data.seed = seed; \
+    data.thread_count = pool->thread_count; \
+    poolRun(pool, randomJob_##S, &data); \
+}
+
+RANDOM_FILL_DEFINE(int32_t, i32)
+RANDOM_FILL_DEFINE(int64_t, i64)
+RANDOM_FILL_DEFINE(uint32_t, u32)
+RANDOM_FILL_DEFINE(uint64_t, u64)
+RANDOM_FILL_DEFINE(float, f32)
+RANDOM_FILL_DEFINE(double, f64)
+
+#endif
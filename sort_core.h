@@ -0,0 +1,345 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Sorting Core
+ *
+ * sort_core.h
+ *
+ * Type-generic sorting routines shared by all four programs
+ *
+ * Every routine is generated once per key type by SORT_CORE_DEFINE, so the
+ * compiler sees the real type and compares with < and > directly (no qsort-style
+ * comparison function pointers). The supported types and their suffixes are:
+ *      int32_t (i32), int64_t (i64), uint32_t (u32), uint64_t (u64),
+ *      float (f32), double (f64)
+ *
+ * A program picks its key type by defining SORT_KEY to one of the suffixes before
+ * including this file (or on the command line, e.g. -DSORT_KEY=u64). It then
+ * gets elem_t for the type, ELEM_FMT for printing it, and SORT(name) which expands
+ * to the routine for that type, e.g. SORT(quickSort) -> quickSort_i32
+ *
+ * Methods (one of each per type, T is the key type):
+ *  - introSortDepth(size_t n) -> int
+ *      Depth limit for sorting n keys, 2 * log2(n) (the same for every type)
+ *
+ *  - swap_<type>(T* array, size_t x, size_t y) -> void
+ *      Swaps the elements at indices x and y
+ *
+ *  - printArray_<type>(T* array, size_t size) -> void
+ *      Prints an array on a single line
+ *
+ *  - isSorted_<type>(const T* array, size_t size) -> bool
+ *      Whether no element is smaller than the one before it
+ *
+ *  - compareExchange_<type>(T* base, size_t pairs) -> bool
+ *      One odd or even phase of odd-even transposition sort (compare_exchange.h)
+ *
+ *  - median3_<type>(T a, T b, T c) -> T
+ *      The middle one of three values
+ *
+ *  - choosePivot_<type>(const T* array, size_t n) -> T
+ *      Median of three for short ranges, ninther (median of three medians) for long ones
+ *
+ *  - partition3_<type>(T* array, size_t n, T pivot, size_t* lt, size_t* gt) -> void
+ *      Dutch national flag partition: [0, lt) < pivot, [lt, gt) == pivot, [gt, n) > pivot
+ *
+ *  - insertionSort_<type>(T* array, size_t n) -> void
+ *      Insertion sort, for short runs
+ *
+ *  - siftDown_<type>(T* array, size_t root, size_t n) -> void
+ *      Restores the max-heap property below root
+ *
+ *  - heapSort_<type>(T* array, size_t n) -> void
+ *      Heapsort, the fallback when introSort recurses too deep
+ *
+ *  - introSort_<type>(T* array, size_t n, int depth) -> void
+ *      Three-way quicksort that switches to heapsort once depth runs out and
+ *      finishes short ranges with insertion sort. O(n log n) in the worst case,
+ *      and ranges of equal keys (very common with small MAX) take one pass
+ *
+ *  - quickSort_<type>(T* array, ptrdiff_t low, ptrdiff_t high) -> void
+ *      Sorts array[low..high] with introSort, depth limit 2 * log2(n)
+ *
+ *  - mergeRuns_<type>(const T* a, size_t na, const T* b, size_t nb, T* out) -> void
+ *      Merges two sorted runs into out
+ *
+ *  - mergeLow_<type>(const T* mine, size_t myCount, const T* partner, size_t partnerCount, T* out) -> void
+ *      Keeps the smallest myCount elements of two sorted runs (lower half of a compare-split)
+ *
+ *  - mergeHigh_<type>(const T* mine, size_t myCount, const T* partner, size_t partnerCount, T* out) -> void
+ *      Keeps the largest myCount elements of two sorted runs (upper half of a compare-split)
+ *
+ *  - mergeSort_<type>(T* array, T* scratch, size_t n) -> void
+ *      Bottom-up merge sort using scratch (at least n elements) as the other buffer
+ *
+ * Resources:
+ *  - https://www.geeksforgeeks.org/quick-sort/
+ *      quickSort started as the one from qs_data.c
+ *
+ *  - Musser, "Introspective Sorting and Selection Algorithms" (1997)
+ *      depth limit and heapsort fallback
+ *
+ *  - Bentley and McIlroy, "Engineering a Sort Function" (1993)
+ *      ninther pivots and three-way partitioning
+ *
+ *  - https://www.geeksforgeeks.org/merge-sort/
+ *      mergeRuns is the merge from oets_task.c
+ */
+#ifndef SORT_CORE_H
+#define SORT_CORE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include "compare_exchange.h"
+
+#define INSERTION_CUTOFF 16 //runs this short are insertion sorted
+#define NINTHER_CUTOFF 128 //ranges this long get a ninther pivot
+
+/**
+ * How many rounds of partitioning n keys get before introsort gives up on
+ * quicksort and heapsorts what's left
+ *
+ * @param n: how many keys are being sorted
+ * @return int: 2 * floor(log2(n))
+ */
+static inline int introSortDepth(size_t n){
+
+    int depth = 0;
+
+    for (size_t m = n ; m > 1 ; m >>= 1){
+        depth += 2;
+    }//for
+
+    return depth;
+
+}//introSortDepth
+
+//the key types, with their suffix and how to print them
+typedef int32_t sort_type_i32;
+typedef int64_t sort_type_i64;
+typedef uint32_t sort_type_u32;
+typedef uint64_t sort_type_u64;
+typedef float sort_type_f32;
+typedef double sort_type_f64;
+
+#define SORT_FMT_i32 "%" PRId32
+#define SORT_FMT_i64 "%" PRId64
+#define SORT_FMT_u32 "%" PRIu32
+#define SORT_FMT_u64 "%" PRIu64
+#define SORT_FMT_f32 "%f"
+#define SORT_FMT_f64 "%lf"
+
+#define SORT_CORE_DEFINE(T, S) \
+\
+static inline void swap_##S(T* array, size_t x, size_t y){ \
+    T temp = array[x]; \
+    array[x] = array[y]; \
+    array[y] = temp; \
+} \
+\
+static inline void printArray_##S(T* array, size_t size){ \
+    for (size_t i = 0 ; i < size ; i++){ \
+        printf(SORT_FMT_##S " ", array[i]); \
+    } \
+    printf("\n"); \
+} \
+\
+static inline bool isSorted_##S(const T* array, size_t size){ \
+    for (size_t i = 1 ; i < size ; i++){ \
+        if (array[i] < array[i - 1]){ \
+            return false; \
+        } \
+    } \
+    return true; \
+} \
+\
+static inline T median3_##S(T a, T b, T c){ \
+    if (a < b){ \
+        if (b < c) return b; \
+        return (a < c) ? c : a; \
+    } \
+    if (a < c) return a; \
+    return (b < c) ? c : b; \
+} \
+\
+static inline T choosePivot_##S(const T* array, size_t n){ \
+    size_t mid = n / 2; \
+    if (n >= NINTHER_CUTOFF){ \
+        size_t s = n / 8; \
+        return median3_##S(median3_##S(array[0], array[s], array[2 * s]), \
+            median3_##S(array[mid - s], array[mid], array[mid + s]), \
+            median3_##S(array[n - 1 - 2 * s], array[n - 1 - s], array[n - 1])); \
+    } \
+    return median3_##S(array[0], array[mid], array[n - 1]); \
+} \
+\
+static inline void partition3_##S(T* array, size_t n, T pivot, size_t* lt, size_t* gt){ \
+    size_t lo = 0, i = 0, hi = n; \
+    while (i < hi){ \
+        if (array[i] < pivot){ \
+            swap_##S(array, lo++, i++); \
+        } \
+        else if (pivot < array[i]){ \
+            swap_##S(array, i, --hi); \
+        } \
+        else{ \
+            i++; \
+        } \
+    } \
+    *lt = lo; \
+    *gt = hi; \
+} \
+\
+static inline void insertionSort_##S(T* array, size_t n){ \
+    for (size_t i = 1 ; i < n ; i++){ \
+        T key = array[i]; \
+        size_t j = i; \
+        while (j > 0 && array[j - 1] > key){ \
+            array[j] = array[j - 1]; \
+            j--; \
+        } \
+        array[j] = key; \
+    } \
+} \
+\
+static inline void siftDown_##S(T* array, size_t root, size_t n){ \
+    T value = array[root]; \
+    size_t child; \
+    while ((child = 2 * root + 1) < n){ \
+        if (child + 1 < n && array[child] < array[child + 1]){ \
+            child++; \
+        } \
+        if (!(value < array[child])){ \
+            break; \
+        } \
+        array[root] = array[child]; \
+        root = child; \
+    } \
+    array[root] = value; \
+} \
+\
+static inline void heapSort_##S(T* array, size_t n){ \
+    for (size_t i = n / 2 ; i > 0 ; i--){ \
+        siftDown_##S(array, i - 1, n); \
+    } \
+    for (size_t end = n ; end > 1 ; end--){ \
+        swap_##S(array, 0, end - 1); \
+        siftDown_##S(array, 0, end - 1); \
+    } \
+} \
+\
+static inline void introSort_##S(T* array, size_t n, int depth){ \
+    size_t lt, gt; \
+    while (n > INSERTION_CUTOFF){ \
+        if (depth-- == 0){ \
+            heapSort_##S(array, n); \
+            return; \
+        } \
+        partition3_##S(array, n, choosePivot_##S(array, n), &lt, &gt); \
+        /* recurse on the smaller side, loop on the larger */ \
+        if (lt < n - gt){ \
+            introSort_##S(array, lt, depth); \
+            array += gt; \
+            n -= gt; \
+        } \
+        else{ \
+            introSort_##S(array + gt, n - gt, depth); \
+            n = lt; \
+        } \
+    } \
+    insertionSort_##S(array, n); \
+} \
+\
+static inline void quickSort_##S(T* array, ptrdiff_t low, ptrdiff_t high){ \
+    if (low < high){ \
+        size_t n = (size_t) (high - low) + 1; \
+        introSort_##S(&array[low], n, introSortDepth(n)); \
+    } \
+} \
+\
+static inline void mergeRuns_##S(const T* a, size_t na, const T* b, size_t nb, T* out){ \
+    size_t i = 0, j = 0, k = 0; \
+    while (i < na && j < nb){ \
+        out[k++] = (b[j] < a[i]) ? b[j++] : a[i++]; \
+    } \
+    while (i < na){ \
+        out[k++] = a[i++]; \
+    } \
+    while (j < nb){ \
+        out[k++] = b[j++]; \
+    } \
+} \
+\
+static inline void mergeLow_##S(const T* mine, size_t myCount, \
+        const T* partner, size_t partnerCount, T* out){ \
+    size_t i = 0, j = 0; \
+    for (size_t k = 0 ; k < myCount ; k++){ \
+        if (j >= partnerCount || (i < myCount && mine[i] <= partner[j])){ \
+            out[k] = mine[i++]; \
+        } \
+        else{ \
+            out[k] = partner[j++]; \
+        } \
+    } \
+} \
+\
+static inline void mergeHigh_##S(const T* mine, size_t myCount, \
+        const T* partner, size_t partnerCount, T* out){ \
+    ptrdiff_t i = (ptrdiff_t) myCount - 1; \
+    ptrdiff_t j = (ptrdiff_t) partnerCount - 1; \
+    for (ptrdiff_t k = (ptrdiff_t) myCount - 1 ; k >= 0 ; k--){ \
+        if (j < 0 || (i >= 0 && mine[i] > partner[j])){ \
+            out[k] = mine[i--]; \
+        } \
+        else{ \
+            out[k] = partner[j--]; \
+        } \
+    } \
+} \
+\
+static inline void mergeSort_##S(T* array, T* scratch, size_t n){ \
+    T* from = array; \
+    T* to = scratch; \
+    for (size_t i = 0 ; i < n ; i += INSERTION_CUTOFF){ \
+        insertionSort_##S(&array[i], (n - i < INSERTION_CUTOFF) ? n - i : INSERTION_CUTOFF); \
+    } \
+    for (size_t width = INSERTION_CUTOFF ; width < n ; width *= 2){ \
+        for (size_t left = 0 ; left < n ; left += 2 * width){ \
+            size_t mid = (left + width < n) ? left + width : n; \
+            size_t right = (left + 2 * width < n) ? left + 2 * width : n; \
+            mergeRuns_##S(&from[left], mid - left, &from[mid], right - mid, &to[left]); \
+        } \
+        T* temp = from; \
+        from = to; \
+        to = temp; \
+    } \
+    if (from != array){ \
+        memcpy(array, from, sizeof(T) * n); \
+    } \
+}
+
+SORT_CORE_DEFINE(int32_t, i32)
+SORT_CORE_DEFINE(int64_t, i64)
+SORT_CORE_DEFINE(uint32_t, u32)
+SORT_CORE_DEFINE(uint64_t, u64)
+SORT_CORE_DEFINE(float, f32)
+SORT_CORE_DEFINE(double, f64)
+
+//pick the routines for the program's key type
+#define SORT_CAT(a, b) a##_##b
+#define SORT_XCAT(a, b) SORT_CAT(a, b)
+#define SORT_PASTE(a, b) a##b
+#define SORT_XPASTE(a, b) SORT_PASTE(a, b)
+
+#ifdef SORT_KEY
+typedef SORT_XPASTE(sort_type_, SORT_KEY) elem_t;
+#define ELEM_FMT SORT_XPASTE(SORT_FMT_, SORT_KEY)
+#define SORT(name) SORT_XCAT(name, SORT_KEY)
+#endif
+
+#endif
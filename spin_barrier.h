@@ -0,0 +1,189 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Odd-Even Transposition Sort
+ *
+ * spin_barrier.h
+ *
+ * Sense-reversing barrier for the sorting threads, with an OR reduction
+ * of one flag per thread built in
+ *
+ * The last thread to arrive combines every thread's flag and then flips the
+ * shared sense to let everyone through, so the "did anybody swap?" question
+ * is answered by the barrier itself with no mutex or shared flag being written
+ * by every thread. Waiting threads spin for a short while (phases are short)
+ * and then sleep on a futex. If there are more threads than cores there is no
+ * point spinning (the thread we wait on can't run), so they go straight to sleep
+ *
+ * Methods:
+ *  - spinBarrierInit(spin_barrier* b, int count) -> void
+ *      Sets up a barrier for count threads
+ *
+ *  - spinBarrierDestroy(spin_barrier* b) -> void
+ *      Frees the per-thread flags
+ *
+ *  - spinBarrierWaitOr(spin_barrier* b, int rank, bool flag) -> bool
+ *      Waits for all count threads, returns the OR of every thread's flag
+ *
+ *  - spinBarrierWait(spin_barrier* b, int rank) -> void
+ *      Waits for all count threads
+ */
+#ifndef SPIN_BARRIER_H
+#define SPIN_BARRIER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#define CACHE_LINE 64 //bytes, keeps every thread's flag on its own line
+#define SPIN_LIMIT 4000 //spins before a waiting thread goes to sleep
+
+//one swap flag per thread, padded so threads never share a cache line
+typedef struct {
+    _Alignas(CACHE_LINE) bool flag;
+} padded_flag;
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_int arrived;
+    _Alignas(CACHE_LINE) atomic_int sense; //flips every time the barrier opens
+    atomic_int sleepers; //threads waiting on the futex
+    int count;
+    int spinLimit; //SPIN_LIMIT, or 0 when there are more threads than cores
+    bool result; //OR of the flags, written by the last thread before it opens
+    padded_flag* flags;
+} spin_barrier;
+
+/**
+ * Tells the cpu we are in a spin loop (lets the other hyperthread run)
+ *
+ * @return void
+ */
+static inline void spinPause(){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}//spinPause
+
+/**
+ * Sets up a barrier for count threads, along with their flags
+ *
+ * @param b: the barrier
+ * @param count: how many threads have to arrive before it opens
+ * @return void
+ */
+static inline void spinBarrierInit(spin_barrier* b, int count){
+
+    atomic_init(&b->arrived, 0);
+    atomic_init(&b->sense, 0);
+    atomic_init(&b->sleepers, 0);
+    b->count = count;
+    b->spinLimit = (count <= sysconf(_SC_NPROCESSORS_ONLN)) ? SPIN_LIMIT : 0;
+    b->result = false;
+    b->flags = aligned_alloc(CACHE_LINE, sizeof(padded_flag) * count);
+
+    if (b->flags == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the barrier\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+}//spinBarrierInit
+
+/**
+ * @param b: the barrier to clean up
+ * @return void
+ */
+static inline void spinBarrierDestroy(spin_barrier* b){
+    free(b->flags);
+}//spinBarrierDestroy
+
+/**
+ * Waits until all the threads have arrived and returns the OR of the flags
+ * they arrived with.
+ *
+ * The sense is read before arriving: it can't flip until this thread arrives,
+ * so the barrier is open again as soon as it differs from what was read.
+ * Threads only ever write their own flag, and only the last thread reads them
+ *
+ * @param b: the barrier
+ * @param rank: rank of the calling thread, picks its flag
+ * @param flag: this thread's contribution to the reduction
+ * @return bool: true if any thread arrived with its flag set
+ */
+static inline bool spinBarrierWaitOr(spin_barrier* b, int rank, bool flag){
+
+    int mySense = atomic_load_explicit(&b->sense, memory_order_acquire);
+
+    b->flags[rank].flag = flag;
+
+    //last one in does the reduction and opens the barrier
+    if (atomic_fetch_add_explicit(&b->arrived, 1, memory_order_acq_rel) == b->count - 1){
+
+        bool any = false;
+
+        for (int i = 0 ; i < b->count ; i++){
+            any |= b->flags[i].flag;
+        }//for
+
+        b->result = any;
+        atomic_store_explicit(&b->arrived, 0, memory_order_relaxed);
+        atomic_store(&b->sense, !mySense);
+
+#ifdef __linux__
+        if (atomic_load(&b->sleepers) > 0){
+            syscall(SYS_futex, &b->sense, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+        }//if
+#endif
+
+        return any;
+
+    }//if
+
+    //spin first, phases are usually short
+    for (int i = 0 ; i < b->spinLimit ; i++){
+
+        if (atomic_load_explicit(&b->sense, memory_order_acquire) != mySense){
+            return b->result;
+        }//if
+
+        spinPause();
+
+    }//for
+
+    //then sleep until the last thread flips the sense
+    while (atomic_load(&b->sense) == mySense){
+#ifdef __linux__
+        atomic_fetch_add(&b->sleepers, 1);
+        syscall(SYS_futex, &b->sense, FUTEX_WAIT_PRIVATE, mySense, NULL, NULL, 0);
+        atomic_fetch_sub(&b->sleepers, 1);
+#else
+        sched_yield();
+#endif
+    }//while
+
+    return b->result;
+
+}//spinBarrierWaitOr
+
+/**
+ * Waits until all the threads have arrived
+ *
+ * @param b: the barrier
+ * @param rank: rank of the calling thread
+ * @return void
+ */
+static inline void spinBarrierWait(spin_barrier* b, int rank){
+    spinBarrierWaitOr(b, rank, false);
+}//spinBarrierWait
+
+#endif
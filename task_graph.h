@@ -0,0 +1,314 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Task Graphs
+ *
+ * task_graph.h
+ *
+ * Tasks with dependencies, run on the work-stealing pool (task_pool.h)
+ *
+ * A program describes its work up front as nodes (a function and its argument)
+ * and edges ("this node needs that one finished first"), and the graph runs
+ * every node as soon as everything it needs is done, on whichever worker is
+ * free. Nothing waits for a whole stage to finish unless a node really needs
+ * all of it, so separate chains of work (different files) overlap on their own
+ * instead of in whatever order the program happened to call them
+ *
+ * Every node counts the nodes it is still waiting on. The worker that finishes
+ * a node counts down each of its successors, and the one that brings a count to
+ * zero spawns that successor as a task, so no thread ever looks for ready nodes.
+ * A node with no function is a join: it finishes as soon as it is ready, which
+ * saves wiring every node of one stage to every node of the next. An event is a
+ * node that also waits on something outside the graph (a file coming in), and
+ * finishes when the program signals it
+ *
+ * The graph is built completely before it starts, and started and waited on
+ * from inside the pool (taskPoolRun), so spawned nodes go on a worker's deque
+ *
+ * Methods:
+ *  - taskGraphInit(task_graph* graph, task_pool* pool) -> void
+ *      Sets up an empty graph to run on pool
+ *
+ *  - taskGraphNode(task_graph* graph, task_fn fn, void* arg) -> task_node*
+ *      Adds a node that runs fn(arg), or a join if fn is NULL
+ *
+ *  - taskGraphEvent(task_graph* graph) -> task_node*
+ *      Adds a node that finishes when taskGraphSignal is called on it
+ *
+ *  - taskGraphDepend(task_node* node, task_node* before) -> void
+ *      node can't start until before has finished
+ *
+ *  - taskGraphStart(task_graph* graph) -> void
+ *      Spawns every node that isn't waiting on anything
+ *
+ *  - taskGraphSignal(task_graph* graph, task_node* event) -> void
+ *      What an event was waiting on outside the graph has happened
+ *
+ *  - taskGraphWait(task_graph* graph) -> void
+ *      Runs tasks until every node has finished
+ *
+ *  - taskGraphFree(task_graph* graph) -> void
+ *      Frees the nodes
+ *
+ *  - taskNodeReady(task_node* node) -> void
+ *      Runs a join (or event) on the spot, or spawns a node with work
+ *
+ *  - taskNodeFinished(task_node* node) -> void
+ *      Counts down every successor of a finished node
+ *
+ *  - taskNodeRun(void* arg) -> void
+ *      Task function
+ *      Runs a node's function, then counts down its successors
+ */
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "task_pool.h"
+
+typedef struct task_graph task_graph;
+typedef struct task_node task_node;
+
+struct task_node {
+    task_fn fn; //NULL for joins and events
+    void* arg;
+    atomic_int waiting; //unfinished nodes (and signals) this one needs
+    task_node** successors; //nodes that need this one
+    int successorCount;
+    int successorCapacity;
+    task_graph* graph;
+};
+
+struct task_graph {
+    task_pool* pool;
+    task_group spawned; //for taskSpawn, node tasks not done with the graph yet
+    task_group remaining; //nodes not finished yet
+    task_node** nodes; //every node, to free them
+    int count;
+    int capacity;
+};
+
+/**
+ * @param graph: the graph to set up
+ * @param pool: the pool its nodes run on
+ * @return void
+ */
+static inline void taskGraphInit(task_graph* graph, task_pool* pool){
+
+    graph->pool = pool;
+    atomic_init(&graph->spawned.pending, 0);
+    atomic_init(&graph->remaining.pending, 0);
+    graph->nodes = NULL;
+    graph->count = 0;
+    graph->capacity = 0;
+
+}//taskGraphInit
+
+/**
+ * @param graph: the graph, not started yet
+ * @param fn: the node's work, NULL for a join
+ * @param arg: passed to fn
+ * @return task_node*: the new node, waiting on nothing so far
+ */
+static inline task_node* taskGraphNode(task_graph* graph, task_fn fn, void* arg){
+
+    task_node* node = (task_node *) malloc(sizeof(task_node));
+
+    if (graph->count == graph->capacity){
+        graph->capacity = (graph->capacity > 0) ? 2 * graph->capacity : 64;
+        graph->nodes = realloc(graph->nodes, sizeof(task_node*) * graph->capacity);
+    }//if
+
+    if (node == NULL || graph->nodes == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the task graph\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    node->fn = fn;
+    node->arg = arg;
+    atomic_init(&node->waiting, 0);
+    node->successors = NULL;
+    node->successorCount = 0;
+    node->successorCapacity = 0;
+    node->graph = graph;
+
+    graph->nodes[graph->count++] = node;
+    atomic_fetch_add_explicit(&graph->remaining.pending, 1, memory_order_relaxed);
+
+    return node;
+
+}//taskGraphNode
+
+/**
+ * @param graph: the graph, not started yet
+ * @return task_node*: a node that waits on taskGraphSignal (and on any
+ *                     nodes it is made to depend on)
+ */
+static inline task_node* taskGraphEvent(task_graph* graph){
+
+    task_node* node = taskGraphNode(graph, NULL, NULL);
+
+    atomic_init(&node->waiting, 1);
+
+    return node;
+
+}//taskGraphEvent
+
+/**
+ * @param node: the node that has to wait
+ * @param before: the node it waits for, in the same graph
+ * @return void
+ */
+static inline void taskGraphDepend(task_node* node, task_node* before){
+
+    if (before->successorCount == before->successorCapacity){
+        before->successorCapacity = (before->successorCapacity > 0) ? 2 * before->successorCapacity : 4;
+        before->successors = realloc(before->successors, sizeof(task_node*) * before->successorCapacity);
+        if (before->successors == NULL){
+            fprintf(stderr, "Couldn't allocate memory for the task graph\n");
+            exit(EXIT_FAILURE);
+        }//if
+    }//if
+
+    before->successors[before->successorCount++] = node;
+    atomic_fetch_add_explicit(&node->waiting, 1, memory_order_relaxed);
+
+}//taskGraphDepend
+
+static inline void taskNodeReady(task_node* node);
+
+/**
+ * Counts down the successors of a node that has finished, starting the ones
+ * that were only waiting on it
+ *
+ * @param node: the finished node
+ * @return void
+ */
+static inline void taskNodeFinished(task_node* node){
+
+    task_graph* graph = node->graph;
+
+    for (int i = 0 ; i < node->successorCount ; i++){
+        //acq_rel: whoever starts a successor sees everything its nodes wrote
+        if (atomic_fetch_sub_explicit(&node->successors[i]->waiting, 1, memory_order_acq_rel) == 1){
+            taskNodeReady(node->successors[i]);
+        }//if
+    }//for
+
+    atomic_fetch_sub_explicit(&graph->remaining.pending, 1, memory_order_release);
+
+}//taskNodeFinished
+
+/**
+ * Task Function
+ *
+ * @param arg: the node to run
+ * @return void
+ */
+static void taskNodeRun(void* arg){
+
+    task_node* node = (task_node *) arg;
+
+    node->fn(node->arg);
+    taskNodeFinished(node);
+
+}//taskNodeRun
+
+/**
+ * @param node: a node that isn't waiting on anything anymore
+ * @return void
+ */
+static inline void taskNodeReady(task_node* node){
+
+    if (node->fn == NULL){
+        taskNodeFinished(node);
+    }//if
+
+    else{
+        taskSpawn(node->graph->pool, &node->graph->spawned, taskNodeRun, node);
+    }//else
+
+}//taskNodeReady
+
+/**
+ * Starts the nodes that aren't waiting on anything. Called from inside the pool
+ *
+ * @param graph: the graph, completely built
+ * @return void
+ */
+static inline void taskGraphStart(task_graph* graph){
+
+    task_node** roots = malloc(sizeof(task_node*) * (graph->count + 1));
+    int rootCount = 0;
+
+    if (roots == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the task graph\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    //found before any of them runs, or a node they make ready would be found too
+    for (int i = 0 ; i < graph->count ; i++){
+        if (atomic_load_explicit(&graph->nodes[i]->waiting, memory_order_relaxed) == 0){
+            roots[rootCount++] = graph->nodes[i];
+        }//if
+    }//for
+
+    for (int i = 0 ; i < rootCount ; i++){
+        taskNodeReady(roots[i]);
+    }//for
+
+    free(roots);
+
+}//taskGraphStart
+
+/**
+ * @param graph: the graph, started
+ * @param event: a node made by taskGraphEvent, signalled once
+ * @return void
+ */
+static inline void taskGraphSignal(task_graph* graph, task_node* event){
+
+    (void) graph; //the node knows its graph
+
+    if (atomic_fetch_sub_explicit(&event->waiting, 1, memory_order_acq_rel) == 1){
+        taskNodeReady(event);
+    }//if
+
+}//taskGraphSignal
+
+/**
+ * Helps run the graph's tasks (and any others) until every node has finished.
+ * Every event has to be signalled first
+ *
+ * The last node takes remaining to zero before the worker running it counts it
+ * off spawned, so spawned is waited on too: the graph may be on the caller's
+ * stack, and nothing can touch it once this returns. Every spawn happens before
+ * the node that made it finishes, so none comes after remaining is zero
+ *
+ * @param graph: the graph, started
+ * @return void
+ */
+static inline void taskGraphWait(task_graph* graph){
+    taskGroupWait(graph->pool, &graph->remaining);
+    taskGroupWait(graph->pool, &graph->spawned);
+}//taskGraphWait
+
+/**
+ * @param graph: the graph to free, finished
+ * @return void
+ */
+static inline void taskGraphFree(task_graph* graph){
+
+    for (int i = 0 ; i < graph->count ; i++){
+        free(graph->nodes[i]->successors);
+        free(graph->nodes[i]);
+    }//for
+
+    free(graph->nodes);
+
+}//taskGraphFree
+
+#endif
@@ -0,0 +1,501 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Quicksort
+ *
+ * task_pool.h
+ *
+ * Work-stealing pool of threads for recursive (fork-join) sorting
+ *
+ * Unlike worker_pool.h, where every worker runs the same job once, work here is
+ * a pile of small tasks that create more tasks as they go (quicksort partitions).
+ * Every worker has its own Chase-Lev deque: it pushes and pops new tasks at the
+ * bottom (newest first, so it stays in cache), while idle workers steal the
+ * oldest tasks from the top of someone else's deque, which are the biggest ones.
+ * Workers that find nothing to do spin for a bit and then sleep on a condition
+ * variable until someone spawns a new task.
+ *
+ * The thread that calls taskPoolRun becomes worker 0 for the duration, so a pool
+ * of thread_count workers only creates thread_count - 1 threads. A thread waiting
+ * on a task group keeps running tasks instead of blocking
+ *
+ * Methods:
+ *  - taskPoolInit(task_pool* pool, int thread_count) -> void
+ *      Creates the helper threads, which sleep until there is work
+ *
+ *  - taskPoolRun(task_pool* pool, task_fn fn, void* arg) -> void
+ *      Runs fn(arg) on the calling thread as worker 0, so it can spawn tasks
+ *
+ *  - taskSpawn(task_pool* pool, task_group* group, task_fn fn, void* arg) -> void
+ *      Queues fn(arg) to run on any worker, counted in group
+ *
+ *  - taskGroupWait(task_pool* pool, task_group* group) -> void
+ *      Runs tasks until every task spawned in group has finished
+ *
+ *  - taskPoolDestroy(task_pool* pool) -> void
+ *      Wakes the helpers, tells them to exit and joins them
+ *
+ *  - dequePush, dequeTake, dequeSteal
+ *      The three Chase-Lev deque operations (owner push/pop, thief steal)
+ *
+ *  - taskFind(task_pool* pool, int rank) -> pool_task*
+ *      Pops from this worker's own deque, or steals from another one
+ *
+ *  - taskWorker(void* arg) -> void*
+ *      Pthread function
+ *      What every helper executes: finds tasks and runs them, sleeps when idle
+ *
+ * Resources:
+ *  - Chase and Lev, "Dynamic Circular Work-Stealing Deque" (SPAA 2005)
+ *  - Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing
+ *    for Weak Memory Models" (PPoPP 2013)
+ *      The memory orderings used in the deque are the ones from this paper
+ */
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "spin_barrier.h"
+
+#define TASK_DEQUE_SIZE 4096 //tasks per deque, a full deque runs new tasks right away
+#define TASK_SPIN_LIMIT 2000 //failed searches before an idle helper goes to sleep
+
+//the work in a task, called once on whichever worker gets to it
+typedef void (*task_fn)(void* arg);
+
+//counts the tasks spawned in it that haven't finished, for waiting on them
+typedef struct {
+    atomic_long pending;
+} task_group;
+
+typedef struct {
+    task_fn fn;
+    void* arg;
+    task_group* group;
+} pool_task;
+
+//one per worker, top and bottom on their own lines since thieves hammer top
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_llong top;
+    _Alignas(CACHE_LINE) atomic_llong bottom;
+    _Atomic(pool_task*) slots[TASK_DEQUE_SIZE];
+} task_deque;
+
+typedef struct {
+    task_deque* deques;
+    pthread_t* handles;
+    int thread_count;
+    int spinLimit; //TASK_SPIN_LIMIT, or 0 when there are more threads than cores
+    atomic_uint epoch; //bumped every time a task is spawned
+    atomic_int sleepers; //helpers waiting on workReady
+    atomic_bool shutdown;
+    pthread_mutex_t lock;
+    pthread_cond_t workReady;
+} task_pool;
+
+//data for each helper thread
+typedef struct {
+    task_pool* pool;
+    int rank;
+} task_worker_data;
+
+//which deque belongs to this thread, -1 outside of the pool
+static _Thread_local int taskRank = -1;
+//picks where to start looking for something to steal
+static _Thread_local unsigned taskSeed = 1;
+
+/**
+ * Owner only. Pushes a task on the bottom of the deque
+ *
+ * @param q: the deque of the calling worker
+ * @param t: task to push
+ * @return bool: false if the deque is full
+ */
+static inline bool dequePush(task_deque* q, pool_task* t){
+
+    long long b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    long long top = atomic_load_explicit(&q->top, memory_order_acquire);
+
+    if (b - top >= TASK_DEQUE_SIZE){
+        return false;
+    }//if
+
+    atomic_store_explicit(&q->slots[b & (TASK_DEQUE_SIZE - 1)], t, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+
+    return true;
+
+}//dequePush
+
+/**
+ * Owner only. Pops the newest task off the bottom of the deque. Only races
+ * with thieves when a single task is left, and settles that with a CAS on top
+ *
+ * @param q: the deque of the calling worker
+ * @return pool_task*: the task, or NULL if the deque was empty
+ */
+static inline pool_task* dequeTake(task_deque* q){
+
+    long long b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    long long top;
+    pool_task* t = NULL;
+
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    top = atomic_load_explicit(&q->top, memory_order_relaxed);
+
+    if (top <= b){
+
+        t = atomic_load_explicit(&q->slots[b & (TASK_DEQUE_SIZE - 1)], memory_order_relaxed);
+
+        //last one: whoever moves top first gets it
+        if (top == b){
+
+            if (!atomic_compare_exchange_strong_explicit(&q->top, &top, top + 1,
+                    memory_order_seq_cst, memory_order_relaxed)){
+                t = NULL;
+            }//if
+
+            atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+
+        }//if
+
+    }//if
+
+    else{
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    }//else
+
+    return t;
+
+}//dequeTake
+
+/**
+ * Any thread. Takes the oldest task off the top of the deque
+ *
+ * @param q: the deque to steal from
+ * @return pool_task*: the task, or NULL if it was empty or another thread won
+ */
+static inline pool_task* dequeSteal(task_deque* q){
+
+    long long top = atomic_load_explicit(&q->top, memory_order_acquire);
+    long long b;
+    pool_task* t;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+
+    if (top >= b){
+        return NULL;
+    }//if
+
+    t = atomic_load_explicit(&q->slots[top & (TASK_DEQUE_SIZE - 1)], memory_order_relaxed);
+
+    if (!atomic_compare_exchange_strong_explicit(&q->top, &top, top + 1,
+            memory_order_seq_cst, memory_order_relaxed)){
+        return NULL;
+    }//if
+
+    return t;
+
+}//dequeSteal
+
+/**
+ * Looks for a task: first in this worker's own deque, then in every other
+ * deque starting from a random one
+ *
+ * @param pool: the pool
+ * @param rank: rank of the calling worker
+ * @return pool_task*: a task to run, or NULL if none was found
+ */
+static inline pool_task* taskFind(task_pool* pool, int rank){
+
+    pool_task* t = dequeTake(&pool->deques[rank]);
+    int victim;
+
+    if (t != NULL || pool->thread_count == 1){
+        return t;
+    }//if
+
+    taskSeed = taskSeed * 1103515245u + 12345u;
+    victim = (int) ((taskSeed >> 16) % (unsigned) pool->thread_count);
+
+    for (int i = 0 ; i < pool->thread_count ; i++){
+
+        if (victim != rank){
+
+            t = dequeSteal(&pool->deques[victim]);
+
+            if (t != NULL){
+                return t;
+            }//if
+
+        }//if
+
+        victim = (victim + 1 == pool->thread_count) ? 0 : victim + 1;
+
+    }//for
+
+    return NULL;
+
+}//taskFind
+
+/**
+ * Runs a task, frees it and lets its group know it is done
+ *
+ * @param t: the task
+ * @return void
+ */
+static inline void taskExecute(pool_task* t){
+
+    task_group* group = t->group;
+
+    t->fn(t->arg);
+    free(t);
+    atomic_fetch_sub_explicit(&group->pending, 1, memory_order_release);
+
+}//taskExecute
+
+/**
+ * Pthread Function
+ *
+ * Runs tasks until the pool shuts down. After spinLimit searches come up empty
+ * it sleeps until the epoch changes (a task was spawned). The sleeper count is
+ * raised before the epoch is checked again and taskSpawn bumps the epoch before
+ * checking the sleeper count, so a spawn can't slip between the two unnoticed
+ *
+ * @param *arg: pointer to the pool and rank of this helper
+ * @return void*
+ */
+static void* taskWorker(void* arg){
+
+    task_pool* pool = ((task_worker_data *) arg)->pool;
+    int rank = ((task_worker_data *) arg)->rank;
+    int idle = 0;
+    unsigned epoch;
+    pool_task* t;
+
+    free(arg);
+    taskRank = rank;
+    taskSeed = (unsigned) rank * 2654435761u + 1;
+
+    while (!atomic_load(&pool->shutdown)){
+
+        t = taskFind(pool, rank);
+
+        if (t != NULL){
+            taskExecute(t);
+            idle = 0;
+            continue;
+        }//if
+
+        if (idle++ < pool->spinLimit){
+            spinPause();
+            continue;
+        }//if
+
+        //one more look, this time knowing which epoch we saw
+        epoch = atomic_load(&pool->epoch);
+        t = taskFind(pool, rank);
+
+        if (t != NULL){
+            taskExecute(t);
+            idle = 0;
+            continue;
+        }//if
+
+        pthread_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->sleepers, 1);
+
+        while (atomic_load(&pool->epoch) == epoch && !atomic_load(&pool->shutdown)){
+            pthread_cond_wait(&pool->workReady, &pool->lock);
+        }//while
+
+        atomic_fetch_sub(&pool->sleepers, 1);
+        pthread_mutex_unlock(&pool->lock);
+        idle = 0;
+
+    }//while
+
+    return NULL;
+
+}//taskWorker
+
+/**
+ * Creates thread_count - 1 helpers (the thread calling taskPoolRun is the other one)
+ *
+ * @param pool: the pool to set up
+ * @param thread_count: how many workers to have, counting the calling thread
+ * @return void
+ */
+static inline void taskPoolInit(task_pool* pool, int thread_count){
+
+    pool->thread_count = thread_count;
+    pool->spinLimit = (thread_count <= sysconf(_SC_NPROCESSORS_ONLN)) ? TASK_SPIN_LIMIT : 0;
+    atomic_init(&pool->epoch, 0);
+    atomic_init(&pool->sleepers, 0);
+    atomic_init(&pool->shutdown, false);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->workReady, NULL);
+
+    pool->deques = aligned_alloc(CACHE_LINE, sizeof(task_deque) * thread_count);
+    pool->handles = malloc(sizeof(pthread_t) * thread_count);
+
+    if (pool->deques == NULL || pool->handles == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the task pool\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    for (int i = 0 ; i < thread_count ; i++){
+        atomic_init(&pool->deques[i].top, 0);
+        atomic_init(&pool->deques[i].bottom, 0);
+    }//for
+
+    for (int i = 1 ; i < thread_count ; i++){
+
+        task_worker_data *my_data =
+            (task_worker_data *) malloc(sizeof(task_worker_data));
+
+        if (my_data == NULL) {
+            fprintf(stderr, "Couldn't allocate memory for thread arg\n");
+            exit(EXIT_FAILURE);
+        }//if
+
+        my_data->pool = pool;
+        my_data->rank = i;
+        pthread_create(&pool->handles[i], NULL, taskWorker, (void *) my_data);
+
+    }//for
+
+}//taskPoolInit
+
+/**
+ * Queues a task on the calling worker's deque and wakes a sleeping helper.
+ * Called from outside the pool, or when the deque is full, the task is just
+ * run right away: it still happens before the group is done, only not in parallel
+ *
+ * @param pool: the pool
+ * @param group: counts the task until it finishes
+ * @param fn: the work
+ * @param arg: passed to fn
+ * @return void
+ */
+static inline void taskSpawn(task_pool* pool, task_group* group, task_fn fn, void* arg){
+
+    pool_task* t;
+
+    if (taskRank < 0){
+        fn(arg);
+        return;
+    }//if
+
+    t = (pool_task *) malloc(sizeof(pool_task));
+
+    if (t == NULL){
+        fprintf(stderr, "Couldn't allocate memory for a task\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    t->fn = fn;
+    t->arg = arg;
+    t->group = group;
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+
+    if (!dequePush(&pool->deques[taskRank], t)){
+        taskExecute(t);
+        return;
+    }//if
+
+    atomic_fetch_add(&pool->epoch, 1);
+
+    if (atomic_load(&pool->sleepers) > 0){
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->workReady);
+        pthread_mutex_unlock(&pool->lock);
+    }//if
+
+}//taskSpawn
+
+/**
+ * Waits until every task spawned in group (and everything they spawned in it)
+ * is done, running tasks from this or other deques in the meantime
+ *
+ * @param pool: the pool
+ * @param group: the tasks to wait for
+ * @return void
+ */
+static inline void taskGroupWait(task_pool* pool, task_group* group){
+
+    pool_task* t;
+
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0){
+
+        t = (taskRank < 0) ? NULL : taskFind(pool, taskRank);
+
+        if (t != NULL){
+            taskExecute(t);
+        }//if
+
+        else if (pool->spinLimit > 0){
+            spinPause();
+        }//else if
+
+        else{
+            sched_yield();
+        }//else
+
+    }//while
+
+}//taskGroupWait
+
+/**
+ * Runs fn(arg) on the calling thread as worker 0, so fn can spawn tasks.
+ * fn should wait on whatever groups it spawns in before returning
+ *
+ * @param pool: the pool
+ * @param fn: the root of the work
+ * @param arg: passed to fn
+ * @return void
+ */
+static inline void taskPoolRun(task_pool* pool, task_fn fn, void* arg){
+
+    (void) pool; //worker 0's deque is found through taskRank
+    taskRank = 0;
+    fn(arg);
+    taskRank = -1;
+
+}//taskPoolRun
+
+/**
+ * Tells the helpers to exit, wakes the sleeping ones and joins them
+ *
+ * @param pool: the pool to tear down
+ * @return void
+ */
+static inline void taskPoolDestroy(task_pool* pool){
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->shutdown, true);
+    pthread_cond_broadcast(&pool->workReady);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 1 ; i < pool->thread_count ; i++){
+        pthread_join(pool->handles[i], NULL);
+    }//for
+
+    free(pool->deques);
+    free(pool->handles);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->workReady);
+
+}//taskPoolDestroy
+
+#endif
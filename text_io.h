@@ -0,0 +1,1077 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Data Files
+ *
+ * text_io.h
+ *
+ * Fast reading and writing of text files of numbers, without fscanf and fprintf
+ *
+ * fscanf("%lf") goes through stdio locking, locale handling and the whole format
+ * string machinery for every single number. Here the file is read with read() in
+ * big blocks, the whitespace between numbers is skipped 16 bytes at a time with
+ * SSE2, and each number is converted by hand:
+ *
+ *  - the digits are gathered into one 64 bit integer and the decimal point and
+ *    exponent into a power of ten
+ *  - if the integer fits in a double's 53 bit mantissa and the power of ten is
+ *    at most 22 (so 10^e is exact too), one multiply or divide gives the correctly
+ *    rounded result (Clinger's fast path). Everything written with "%lf" (six
+ *    decimals) takes this path
+ *  - anything else (very long or very big/small numbers, inf, nan) is handed to strtod
+ *
+ * The reading is kept in a text_stream, so the numbers can also be taken a few
+ * at a time as the text comes in (from a pipe, say) instead of all at once, and
+ * straight into any key type: whole numbers for integer keys are converted as
+ * integers, since a double only holds them exactly up to 2^53
+ *
+ * A big file can also be parsed by many threads at once, without any thread
+ * parsing somebody else's numbers: the file is cut into byte ranges, every cut
+ * moved to the whitespace after the number it falls in, and every thread first
+ * counts the numbers in its range, then (once everyone knows where their numbers
+ * go) parses them straight into place
+ *
+ * Writing goes the other way: numbers are formatted by hand into one big buffer
+ * that is handed to write() whenever it fills up, instead of one fprintf call per
+ * number. The text is exactly what printf would give ("%lf" for floating point
+ * keys, "%d"/"%u" style for integers). For "%lf" the double is split into its
+ * 53 bit mantissa and power of two, so value * 10^6 can be worked out exactly in
+ * 128 bit integers and rounded half to even like glibc does
+ *
+ * Methods:
+ *  - textParseDoubles(int fd, double** values) -> size_t
+ *      Parses every number in a file into a new array, returns how many there were
+ *
+ *  - textStreamInit(text_stream* stream, int fd) -> void
+ *      Sets up parsing a file (or pipe) a piece at a time
+ *
+ *  - textStreamNext_<type>(text_stream* stream, T* out, size_t max) -> size_t
+ *      Parses up to max more numbers as keys of a type, fewer only once the text
+ *      has ended (or at the first thing that isn't a number of that type)
+ *
+ *  - textStreamToken(text_stream* stream, const char** start, const char** end) -> bool
+ *      Finds the next number, reading more of the file as needed
+ *
+ *  - textStreamFill(text_stream* stream, size_t kept) -> void
+ *      Reads the next block after an unfinished number
+ *
+ *  - textStreamClose(text_stream* stream) -> void
+ *      Frees the buffer
+ *
+ *  - textParseDoublesSplit(worker_pool* pool, int fd, size_t size, double** values) -> size_t
+ *      The same, with every thread of the pool parsing its own byte range of the file
+ *      (for big files, see TEXT_SPLIT_MIN)
+ *
+ *  - textSplitPoint(const char* text, size_t size, size_t offset) -> size_t
+ *      Moves a split between two ranges off any number it cuts
+ *
+ *  - textRange(const text_split* split, int rank, const char** start, const char** end) -> void
+ *      The byte range a thread parses
+ *
+ *  - textCountJob(int rank, void* arg), textParseJob(int rank, void* arg) -> void
+ *      Worker pool jobs, the two passes of a split parse: counting the numbers in
+ *      every range, then parsing every range into its place
+ *
+ *  - parseNumber(const char* start, const char* end, double* value) -> bool
+ *      Converts one number (the text between start and end)
+ *
+ *  - parseSigned, parseUnsigned, parseReal(start, end, lo, hi, value) -> bool
+ *      Convert one number to a key in [lo, hi], whole numbers exactly for integer keys
+ *
+ *  - skipSpace(const char* p, const char* end) -> const char*
+ *      First character at or after p that isn't whitespace (or end)
+ *
+ *  - skipToken(const char* p, const char* end) -> const char*
+ *      First whitespace at or after p (or end)
+ *
+ *  - textWriterOpen(text_writer* out, const char* filename) -> void
+ *      Creates (or truncates) a file to write numbers to
+ *
+ *  - textWriterFlush(text_writer* out) -> void
+ *      write()s out everything in the buffer
+ *
+ *  - textWriterClose(text_writer* out) -> void
+ *      Flushes and closes the file
+ *
+ *  - formatUnsigned(uint64_t value, char* out) -> size_t
+ *  - formatSigned(int64_t value, char* out) -> size_t
+ *  - formatFixed6(double value, char* out) -> size_t
+ *      Write a number the way "%llu", "%lld" and "%lf" would, return its length
+ *
+ *  - textWriteNumbers_<type>(text_writer* out, const T* values, size_t count) -> void
+ *      Writes count numbers each followed by a space, like fprintf(fp, FMT " ", ...)
+ *
+ * Resources:
+ *  - Clinger, "How to Read Floating Point Numbers Accurately" (PLDI 1990)
+ *  - Lemire, "Number Parsing at a Gigabyte per Second" (2021)
+ *      the fast path and when it is exact
+ */
+#ifndef TEXT_IO_H
+#define TEXT_IO_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "worker_pool.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define TEXT_BLOCK (1 << 20) //bytes read at a time
+#define TEXT_PAD 16 //room past the end of the data for one SSE2 load
+#define TEXT_MAX_TOKEN 512 //longest number handled (longer ones end the parse)
+#define TEXT_OUT_BLOCK (1 << 20) //bytes written at a time
+#define TEXT_MAX_NUMBER 320 //longest number written, "%lf" of -DBL_MAX is 317 characters
+#define TEXT_SPLIT_MIN (16 << 20) //bytes of text worth parsing with more than one thread
+
+//a file being written, through one big buffer
+typedef struct {
+    int fd;
+    char* buffer;
+    size_t used;
+} text_writer;
+
+//a file (or pipe) of text being parsed a piece at a time
+typedef struct {
+    int fd;
+    char* buffer; //one read, after up to TEXT_MAX_TOKEN bytes kept from the last
+    const char* p; //next character to parse
+    const char* end; //end of the text read so far
+    bool eof; //the last read found the end of the file
+    bool done; //nothing more will be parsed
+} text_stream;
+
+//one text file being parsed by every thread of a pool, a byte range each
+typedef struct {
+    const char* text;
+    size_t size;
+    int ranges; //one per thread
+    size_t* counts; //numbers in each range, then where each range's numbers go
+    size_t* parsed; //numbers each range parsed before something that wasn't one
+    double* out;
+} text_split;
+
+//exact powers of ten, 10^22 is the last one a double holds exactly
+static const double textPowers[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Anything from 0 to ' ' counts as whitespace, like the space, tab and newline
+ * written between the numbers
+ *
+ * @param p: where to start
+ * @param end: end of the text, at least TEXT_PAD readable bytes must follow it
+ * @return const char*: first non-whitespace character, or end
+ */
+static inline const char* skipSpace(const char* p, const char* end){
+
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+
+    while (p < end){
+
+        __m128i chunk = _mm_loadu_si128((const __m128i *) p);
+        //c <= ' ' exactly when min(c, ' ') == c, unsigned
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(chunk, space), chunk));
+
+        if (mask != 0xFFFF){
+            p += __builtin_ctz(~mask);
+            return (p < end) ? p : end;
+        }//if
+
+        p += 16;
+
+    }//while
+
+    return end;
+#else
+    while (p < end && (unsigned char) *p <= ' '){
+        p++;
+    }//while
+
+    return p;
+#endif
+
+}//skipSpace
+
+/**
+ * @param p: start of a number
+ * @param end: end of the text, at least TEXT_PAD readable bytes must follow it
+ * @return const char*: first whitespace character after it, or end
+ */
+static inline const char* skipToken(const char* p, const char* end){
+
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+
+    while (p < end){
+
+        __m128i chunk = _mm_loadu_si128((const __m128i *) p);
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(chunk, space), chunk));
+
+        if (mask != 0){
+            p += __builtin_ctz(mask);
+            return (p < end) ? p : end;
+        }//if
+
+        p += 16;
+
+    }//while
+
+    return end;
+#else
+    while (p < end && (unsigned char) *p > ' '){
+        p++;
+    }//while
+
+    return p;
+#endif
+
+}//skipToken
+
+/**
+ * Converts the number in [start, end) to a double, exactly as strtod would
+ *
+ * @param start: first character of the number
+ * @param end: one past its last character
+ * @param value: set to the number
+ * @return bool: false if the text isn't a number
+ */
+static inline bool parseNumber(const char* start, const char* end, double* value){
+
+    const char* p = start;
+    bool negative = false;
+    uint64_t mantissa = 0;
+    int digits = 0; //significant digits in mantissa
+    int exponent = 0; //power of ten to scale mantissa by
+    int expValue = 0;
+    bool expNegative = false;
+    bool any = false;
+    char copy[TEXT_MAX_TOKEN + 1];
+    char* stop;
+
+    if (p < end && (*p == '-' || *p == '+')){
+        negative = (*p == '-');
+        p++;
+    }//if
+
+    //integer part
+    for ( ; p < end && *p >= '0' && *p <= '9' ; p++){
+
+        any = true;
+
+        if (mantissa == 0 && *p == '0'){
+            continue; //leading zeros don't count
+        }//if
+
+        if (digits < 19){
+            mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+            digits++;
+        }//if
+
+        else{
+            exponent++; //dropped digit, fast path is off
+            digits = 20;
+        }//else
+
+    }//for
+
+    //fraction
+    if (p < end && *p == '.'){
+
+        for (p++ ; p < end && *p >= '0' && *p <= '9' ; p++){
+
+            any = true;
+
+            if (mantissa == 0 && *p == '0'){
+                exponent--;
+                continue;
+            }//if
+
+            if (digits < 19){
+                mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+                digits++;
+                exponent--;
+            }//if
+
+            else{
+                digits = 20;
+            }//else
+
+        }//for
+
+    }//if
+
+    //exponent
+    if (any && p < end && (*p == 'e' || *p == 'E')){
+
+        p++;
+
+        if (p < end && (*p == '-' || *p == '+')){
+            expNegative = (*p == '-');
+            p++;
+        }//if
+
+        if (p == end || *p < '0' || *p > '9'){
+            any = false;
+        }//if
+
+        for ( ; p < end && *p >= '0' && *p <= '9' ; p++){
+            expValue = (expValue < 10000) ? expValue * 10 + (*p - '0') : expValue;
+        }//for
+
+        exponent += expNegative ? -expValue : expValue;
+
+    }//if
+
+    //Clinger's fast path: both the mantissa and the power of ten are exact
+    if (any && p == end && digits <= 19 && mantissa <= (UINT64_C(1) << 53)
+            && exponent >= -22 && exponent <= 22){
+
+        double result = (double) mantissa;
+
+        result = (exponent < 0) ? result / textPowers[-exponent] : result * textPowers[exponent];
+        *value = negative ? -result : result;
+        return true;
+
+    }//if
+
+    //too many digits, too far out, inf or nan: let strtod do it properly
+    if (end - start > TEXT_MAX_TOKEN){
+        return false;
+    }//if
+
+    memcpy(copy, start, end - start);
+    copy[end - start] = '\0';
+    *value = strtod(copy, &stop);
+
+    return stop == copy + (end - start) && stop != copy;
+
+}//parseNumber
+
+/**
+ * Converts a number to a signed integer key. A plain whole number is converted
+ * digit by digit, so keys past 2^53 (where a double starts dropping digits) come
+ * out exact; anything with a fraction or exponent goes through parseNumber and
+ * is cut down to a whole number like a cast would
+ *
+ * @param start: first character of the number
+ * @param end: one past its last character
+ * @param lo: smallest key the type holds
+ * @param hi: largest key the type holds
+ * @param value: set to the number
+ * @return bool: false if the text isn't a number or it's outside [lo, hi]
+ */
+static inline bool parseSigned(const char* start, const char* end, int64_t lo, int64_t hi, int64_t* value){
+
+    const char* p = start;
+    bool negative = false;
+    uint64_t magnitude = 0;
+    double real;
+
+    if (p < end && (*p == '-' || *p == '+')){
+        negative = (*p == '-');
+        p++;
+    }//if
+
+    for ( ; p < end && *p >= '0' && *p <= '9' ; p++){
+
+        if (magnitude > (UINT64_MAX - (uint64_t) (*p - '0')) / 10){
+            return false;
+        }//if
+
+        magnitude = magnitude * 10 + (uint64_t) (*p - '0');
+
+    }//for
+
+    //a whole number, checked against the range before it's negated
+    if (p == end && p > start && (p[-1] >= '0' && p[-1] <= '9')){
+
+        if (negative){
+
+            if (magnitude > (uint64_t) -(lo + 1) + 1){
+                return false;
+            }//if
+
+            *value = (magnitude == 0) ? 0 : -(int64_t) (magnitude - 1) - 1;
+            return true;
+
+        }//if
+
+        if (magnitude > (uint64_t) hi){
+            return false;
+        }//if
+
+        *value = (int64_t) magnitude;
+        return true;
+
+    }//if
+
+    if (!parseNumber(start, end, &real) || !(real >= (double) lo && real < (double) hi + 1.0)){
+        return false;
+    }//if
+
+    *value = (int64_t) real;
+    return true;
+
+}//parseSigned
+
+/**
+ * The same for an unsigned integer key
+ *
+ * @param start: first character of the number
+ * @param end: one past its last character
+ * @param lo: smallest key the type holds
+ * @param hi: largest key the type holds
+ * @param value: set to the number
+ * @return bool: false if the text isn't a number or it's outside [lo, hi]
+ */
+static inline bool parseUnsigned(const char* start, const char* end, uint64_t lo, uint64_t hi, uint64_t* value){
+
+    const char* p = start;
+    uint64_t magnitude = 0;
+    double real;
+
+    if (p < end && *p == '+'){
+        p++;
+    }//if
+
+    for ( ; p < end && *p >= '0' && *p <= '9' ; p++){
+
+        if (magnitude > (UINT64_MAX - (uint64_t) (*p - '0')) / 10){
+            return false;
+        }//if
+
+        magnitude = magnitude * 10 + (uint64_t) (*p - '0');
+
+    }//for
+
+    if (p == end && p > start && (p[-1] >= '0' && p[-1] <= '9')){
+
+        if (magnitude < lo || magnitude > hi){
+            return false;
+        }//if
+
+        *value = magnitude;
+        return true;
+
+    }//if
+
+    if (!parseNumber(start, end, &real) || !(real >= (double) lo && real < (double) hi + 1.0)){
+        return false;
+    }//if
+
+    *value = (uint64_t) real;
+    return true;
+
+}//parseUnsigned
+
+/**
+ * The same for a floating point key, which is just parseNumber: lo and hi are
+ * only there so every key type is parsed the same way
+ *
+ * @param start: first character of the number
+ * @param end: one past its last character
+ * @param lo: smallest key the type holds
+ * @param hi: largest key the type holds
+ * @param value: set to the number
+ * @return bool: false if the text isn't a number or it's outside [lo, hi] (nan isn't)
+ */
+static inline bool parseReal(const char* start, const char* end, double lo, double hi, double* value){
+    return parseNumber(start, end, value) && !(*value < lo || *value > hi);
+}//parseReal
+
+/**
+ * @param stream: the stream to set up
+ * @param fd: the file (or pipe), read from where it is to its end
+ * @return void
+ */
+static inline void textStreamInit(text_stream* stream, int fd){
+
+    stream->fd = fd;
+    stream->buffer = malloc(TEXT_BLOCK + TEXT_MAX_TOKEN + TEXT_PAD);
+
+    if (stream->buffer == NULL){
+        fprintf(stderr, "Couldn't allocate memory to parse a text file\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    stream->p = stream->buffer;
+    stream->end = stream->buffer;
+    stream->eof = false;
+    stream->done = false;
+
+}//textStreamInit
+
+/**
+ * Reads the next block, after the kept bytes of an unfinished number at the front
+ *
+ * @param stream: the stream, not at the end of its file
+ * @param kept: bytes already at the front of the buffer
+ * @return void
+ */
+static inline void textStreamFill(text_stream* stream, size_t kept){
+
+    ssize_t got;
+
+    do {
+        got = read(stream->fd, stream->buffer + kept, TEXT_BLOCK);
+    } while (got < 0 && errno == EINTR);
+
+    if (got < 0){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    //end of the file ends the last number too
+    stream->eof = (got == 0);
+    stream->p = stream->buffer;
+    stream->end = stream->buffer + kept + got;
+    memset((char *) stream->end, ' ', TEXT_PAD);
+
+}//textStreamFill
+
+/**
+ * Finds the next number in the text, reading more of the file when the text
+ * runs out or a number might go on past what has been read. A pipe is parsed as
+ * its data comes in, a read at a time
+ *
+ * @param stream: the stream
+ * @param start: set to the first character of the number
+ * @param end: set to one past its last character
+ * @return bool: false once the text has ended
+ */
+static inline bool textStreamToken(text_stream* stream, const char** start, const char** end){
+
+    const char *p = stream->p;
+    const char *tokenEnd;
+    size_t kept;
+
+    while (!stream->done){
+
+        p = skipSpace(p, stream->end);
+
+        if (p == stream->end){
+
+            if (stream->eof){
+                stream->done = true;
+            }//if
+
+            else{
+                textStreamFill(stream, 0);
+                p = stream->p;
+            }//else
+
+            continue;
+
+        }//if
+
+        tokenEnd = skipToken(p, stream->end);
+
+        //might go on in the next read
+        if (tokenEnd == stream->end && !stream->eof){
+
+            kept = stream->end - p;
+
+            if (kept > TEXT_MAX_TOKEN){
+                stream->done = true;
+                break;
+            }//if
+
+            memmove(stream->buffer, p, kept);
+            textStreamFill(stream, kept);
+            p = stream->p;
+            continue;
+
+        }//if
+
+        *start = p;
+        *end = tokenEnd;
+        stream->p = tokenEnd;
+        return true;
+
+    }//while
+
+    stream->p = p;
+
+    return false;
+
+}//textStreamToken
+
+#define TEXT_STREAM_DEFINE(T, S, WIDE, PARSE, LO, HI) \
+\
+static inline size_t textStreamNext_##S(text_stream* stream, T* out, size_t max){ \
+    const char* start; \
+    const char* end; \
+    WIDE value; \
+    size_t count = 0; \
+    while (count < max && textStreamToken(stream, &start, &end)){ \
+        if (!PARSE(start, end, LO, HI, &value)){ \
+            stream->done = true; \
+            break; \
+        } \
+        out[count++] = (T) value; \
+    } \
+    return count; \
+}
+
+//integer keys are parsed as integers, so 64 bit ones don't lose digits in a double
+TEXT_STREAM_DEFINE(int32_t, i32, int64_t, parseSigned, INT32_MIN, INT32_MAX)
+TEXT_STREAM_DEFINE(int64_t, i64, int64_t, parseSigned, INT64_MIN, INT64_MAX)
+TEXT_STREAM_DEFINE(uint32_t, u32, uint64_t, parseUnsigned, 0, UINT32_MAX)
+TEXT_STREAM_DEFINE(uint64_t, u64, uint64_t, parseUnsigned, 0, UINT64_MAX)
+TEXT_STREAM_DEFINE(float, f32, double, parseReal, -HUGE_VAL, HUGE_VAL)
+TEXT_STREAM_DEFINE(double, f64, double, parseReal, -HUGE_VAL, HUGE_VAL)
+
+/**
+ * @param stream: the stream to clean up, the file is left open
+ * @return void
+ */
+static inline void textStreamClose(text_stream* stream){
+    free(stream->buffer);
+}//textStreamClose
+
+/**
+ * Parses every whitespace separated number in a file. The file is read a block
+ * at a time through a text_stream; a number cut off at the end of a block is
+ * moved to the front before the next block is read after it. Parsing stops at
+ * the first thing that isn't a number
+ *
+ * @param fd: the file, read from where it is to its end
+ * @param values: set to a new array (malloc) holding the numbers
+ * @return size_t: how many numbers were parsed
+ */
+static inline size_t textParseDoubles(int fd, double** values){
+
+    text_stream stream;
+    size_t capacity = 1024;
+    size_t count = 0;
+    size_t got;
+    double* out = malloc(sizeof(double) * capacity);
+
+    if (out == NULL){
+        fprintf(stderr, "Couldn't allocate memory to parse a text file\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    textStreamInit(&stream, fd);
+
+    //whatever fits, then twice the room, until the text runs out
+    while ((got = textStreamNext_f64(&stream, &out[count], capacity - count)) == capacity - count){
+
+        count = capacity;
+        capacity *= 2;
+        out = realloc(out, sizeof(double) * capacity);
+
+        if (out == NULL){
+            fprintf(stderr, "Couldn't allocate memory to parse a text file\n");
+            exit(EXIT_FAILURE);
+        }//if
+
+    }//while
+
+    count += got;
+    textStreamClose(&stream);
+    *values = out;
+
+    return count;
+
+}//textParseDoubles
+
+/**
+ * Where the range of text starting near offset really starts: a number that
+ * straddles offset belongs to the range before, so a split inside one moves to
+ * the whitespace after it. Both ranges around a split work it out the same way
+ *
+ * @param text: the whole text, TEXT_PAD readable bytes after its end
+ * @param size: its length
+ * @param offset: where the range would start if numbers didn't matter
+ * @return size_t: where it starts
+ */
+static inline size_t textSplitPoint(const char* text, size_t size, size_t offset){
+
+    if (offset == 0 || offset >= size || (unsigned char) text[offset - 1] <= ' '){
+        return (offset < size) ? offset : size;
+    }//if
+
+    return skipToken(text + offset, text + size) - text;
+
+}//textSplitPoint
+
+/**
+ * @param split: the text being parsed
+ * @param rank: which range
+ * @param start: set to where the range starts
+ * @param end: set to where it ends (where the next one starts)
+ * @return void
+ */
+static inline void textRange(const text_split* split, int rank, const char** start, const char** end){
+
+    *start = split->text + textSplitPoint(split->text, split->size, chunkStart(rank, split->ranges, split->size));
+    *end = split->text + textSplitPoint(split->text, split->size, chunkStart(rank + 1, split->ranges, split->size));
+
+}//textRange
+
+/**
+ * Worker Pool Job
+ *
+ * First pass: counts the numbers in this thread's range of the text, so every
+ * range knows where its numbers go before any are parsed
+ *
+ * @param rank: which range
+ * @param arg: the text_split
+ * @return void
+ */
+static void textCountJob(int rank, void* arg){
+
+    text_split* split = (text_split *) arg;
+    const char *p, *end;
+    size_t count = 0;
+
+    textRange(split, rank, &p, &end);
+
+    while ((p = skipSpace(p, end)) < end){
+        p = skipToken(p, end);
+        count++;
+    }//while
+
+    split->counts[rank] = count;
+
+}//textCountJob
+
+/**
+ * Worker Pool Job
+ *
+ * Second pass: parses this thread's range straight into its place in the output,
+ * stopping at the first thing that isn't a number
+ *
+ * @param rank: which range
+ * @param arg: the text_split, counts holding where each range's numbers go
+ * @return void
+ */
+static void textParseJob(int rank, void* arg){
+
+    text_split* split = (text_split *) arg;
+    double* out = split->out + split->counts[rank];
+    const char *p, *end, *tokenEnd;
+    size_t count = 0;
+
+    textRange(split, rank, &p, &end);
+
+    while ((p = skipSpace(p, end)) < end){
+
+        tokenEnd = skipToken(p, end);
+
+        if (!parseNumber(p, tokenEnd, &out[count])){
+            break;
+        }//if
+
+        count++;
+        p = tokenEnd;
+
+    }//while
+
+    split->parsed[rank] = count;
+
+}//textParseJob
+
+/**
+ * Parses every whitespace separated number in a file with every thread of a pool.
+ * The file is mapped and cut into one byte range per thread, moved so no number is
+ * cut in two. Every thread counts the numbers in its range, the counts are added
+ * up into where each range's numbers go, and then every thread parses its range
+ * straight into place. Like textParseDoubles, the numbers end at the first thing
+ * that isn't one
+ *
+ * @param pool: the threads to parse with
+ * @param fd: the file
+ * @param size: its length in bytes
+ * @param values: set to a new array (malloc) holding the numbers
+ * @return size_t: how many numbers were parsed
+ */
+static inline size_t textParseDoublesSplit(worker_pool* pool, int fd, size_t size, double** values){
+
+    text_split split;
+    size_t total = 0;
+    size_t count;
+    char* map;
+
+    //the file with zero pages after it, so the SSE2 loads can run past its end
+    map = mmap(NULL, size + TEXT_PAD, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (map == MAP_FAILED || mmap(map, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    madvise(map, size, MADV_WILLNEED);
+
+    split.text = map;
+    split.size = size;
+    split.ranges = pool->thread_count;
+    split.counts = malloc(sizeof(size_t) * split.ranges);
+    split.parsed = malloc(sizeof(size_t) * split.ranges);
+
+    if (split.counts == NULL || split.parsed == NULL){
+        fprintf(stderr, "Couldn't allocate memory to parse a text file\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    poolRun(pool, textCountJob, &split);
+
+    //counts become where each range starts in the output
+    for (int r = 0 ; r < split.ranges ; r++){
+        count = split.counts[r];
+        split.counts[r] = total;
+        total += count;
+    }//for
+
+    split.out = malloc(sizeof(double) * (total + 1));
+
+    if (split.out == NULL){
+        fprintf(stderr, "Couldn't allocate memory to parse a text file\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    poolRun(pool, textParseJob, &split);
+
+    //everything up to the first range that stopped early
+    count = total;
+
+    for (int r = 0 ; r < split.ranges ; r++){
+
+        if (split.counts[r] + split.parsed[r] < ((r + 1 < split.ranges) ? split.counts[r + 1] : total)){
+            count = split.counts[r] + split.parsed[r];
+            break;
+        }//if
+
+    }//for
+
+    munmap(map, size + TEXT_PAD);
+    free(split.counts);
+    free(split.parsed);
+    *values = split.out;
+
+    return count;
+
+}//textParseDoublesSplit
+
+/**
+ * Creates (or truncates) a file to write numbers to
+ *
+ * @param out: the writer to set up
+ * @param filename: the file to write
+ * @return void
+ */
+static inline void textWriterOpen(text_writer* out, const char* filename){
+
+    out->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    out->buffer = malloc(TEXT_OUT_BLOCK);
+    out->used = 0;
+
+    if (out->fd < 0){
+        perror("Error");
+        exit(EXIT_FAILURE);
+    }//if
+
+    if (out->buffer == NULL){
+        fprintf(stderr, "Couldn't allocate memory to write a text file\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+}//textWriterOpen
+
+/**
+ * Writes out everything in the buffer (write() may take it in several goes)
+ *
+ * @param out: the writer
+ * @return void
+ */
+static inline void textWriterFlush(text_writer* out){
+
+    size_t done = 0;
+    ssize_t wrote;
+
+    while (done < out->used){
+
+        wrote = write(out->fd, out->buffer + done, out->used - done);
+
+        if (wrote < 0){
+            perror("Error");
+            exit(EXIT_FAILURE);
+        }//if
+
+        done += wrote;
+
+    }//while
+
+    out->used = 0;
+
+}//textWriterFlush
+
+/**
+ * @param out: the writer to flush and close
+ * @return void
+ */
+static inline void textWriterClose(text_writer* out){
+
+    textWriterFlush(out);
+    close(out->fd);
+    free(out->buffer);
+
+}//textWriterClose
+
+/**
+ * Writes the digits of value, like "%llu"
+ *
+ * @param value: the number
+ * @param out: where to write it (at least 20 characters)
+ * @return size_t: how many characters were written
+ */
+static inline size_t formatUnsigned(uint64_t value, char* out){
+
+    char digits[20];
+    size_t n = 0;
+
+    do {
+        digits[n++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    for (size_t i = 0 ; i < n ; i++){
+        out[i] = digits[n - 1 - i];
+    }//for
+
+    return n;
+
+}//formatUnsigned
+
+/**
+ * Writes value like "%lld"
+ *
+ * @param value: the number
+ * @param out: where to write it (at least 20 characters)
+ * @return size_t: how many characters were written
+ */
+static inline size_t formatSigned(int64_t value, char* out){
+
+    if (value < 0){
+        out[0] = '-';
+        return 1 + formatUnsigned(-(uint64_t) value, out + 1);
+    }//if
+
+    return formatUnsigned((uint64_t) value, out);
+
+}//formatSigned
+
+/**
+ * Writes value exactly like "%lf" (six decimals, rounded half to even on the
+ * exact binary value). value = mantissa * 2^exponent, so value * 10^6 is
+ * mantissa * 10^6 (under 2^73) shifted by exponent, which fits in 128 bits
+ * for anything under 2^53. Bigger numbers, inf and nan go through snprintf
+ *
+ * @param value: the number
+ * @param out: where to write it (at least TEXT_MAX_NUMBER characters)
+ * @return size_t: how many characters were written
+ */
+static inline size_t formatFixed6(double value, char* out){
+
+    uint64_t bits;
+    uint64_t mantissa;
+    int exponent;
+    unsigned __int128 scaled, remainder, half;
+    uint64_t whole, fraction;
+    size_t n = 0;
+
+    memcpy(&bits, &value, sizeof(bits));
+    exponent = (int) ((bits >> 52) & 0x7FF);
+    mantissa = bits & ((UINT64_C(1) << 52) - 1);
+
+    if (exponent == 0x7FF || exponent - 1075 > 0){
+        return (size_t) snprintf(out, TEXT_MAX_NUMBER, "%lf", value);
+    }//if
+
+    //subnormals have no hidden bit and the smallest exponent
+    if (exponent == 0){
+        exponent = 1;
+    }//if
+
+    else{
+        mantissa |= UINT64_C(1) << 52;
+    }//else
+
+    exponent -= 1075;
+    scaled = (unsigned __int128) mantissa * 1000000u;
+
+    if (exponent < 0){
+
+        int shift = -exponent;
+
+        //anything shifted this far is under a half, rounds to 0
+        if (shift > 80){
+            scaled = 0;
+        }//if
+
+        else{
+
+            remainder = scaled & (((unsigned __int128) 1 << shift) - 1);
+            half = (unsigned __int128) 1 << (shift - 1);
+            scaled >>= shift;
+
+            if (remainder > half || (remainder == half && (scaled & 1))){
+                scaled++;
+            }//if
+
+        }//else
+
+    }//if
+
+    whole = (uint64_t) (scaled / 1000000u);
+    fraction = (uint64_t) (scaled % 1000000u);
+
+    if (bits >> 63){
+        out[n++] = '-';
+    }//if
+
+    n += formatUnsigned(whole, out + n);
+    out[n++] = '.';
+
+    for (int i = 5 ; i >= 0 ; i--){
+        out[n + i] = (char) ('0' + fraction % 10);
+        fraction /= 10;
+    }//for
+
+    return n + 6;
+
+}//formatFixed6
+
+#define TEXT_FORMAT_DEFINE(T, S, FORMAT, CAST) \
+\
+static inline void textWriteNumbers_##S(text_writer* out, const T* values, size_t count){ \
+    for (size_t i = 0 ; i < count ; i++){ \
+        if (out->used > TEXT_OUT_BLOCK - TEXT_MAX_NUMBER - 1){ \
+            textWriterFlush(out); \
+        } \
+        out->used += FORMAT((CAST) values[i], out->buffer + out->used); \
+        out->buffer[out->used++] = ' '; \
+    } \
+}
+
+TEXT_FORMAT_DEFINE(int32_t, i32, formatSigned, int64_t)
+TEXT_FORMAT_DEFINE(int64_t, i64, formatSigned, int64_t)
+TEXT_FORMAT_DEFINE(uint32_t, u32, formatUnsigned, uint64_t)
+TEXT_FORMAT_DEFINE(uint64_t, u64, formatUnsigned, uint64_t)
+TEXT_FORMAT_DEFINE(float, f32, formatFixed6, double)
+TEXT_FORMAT_DEFINE(double, f64, formatFixed6, double)
+
+#endif
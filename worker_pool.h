@@ -0,0 +1,262 @@
+/**
+ * AUCSC 310/450
+ * Combined Term Project
+ * Odd-Even Transposition Sort
+ *
+ * worker_pool.h
+ *
+ * Persistent pool of sorting threads shared by the odd-even programs
+ *
+ * The threads are created once and park on a condition variable between jobs.
+ * A job is a function that every worker runs once with its own rank, so handing
+ * out new chunk ranges is just starting a new job instead of creating and
+ * joining fresh threads for every sort
+ *
+ * Methods:
+ *  - poolInit(worker_pool* pool, int thread_count) -> void
+ *      Creates the worker threads, which wait for their first job
+ *
+ *  - poolStart(worker_pool* pool, pool_job job, void* arg) -> void
+ *      Hands a job to every worker and returns without waiting for it
+ *
+ *  - poolWait(worker_pool* pool) -> void
+ *      Waits until every worker has finished the current job
+ *
+ *  - poolRun(worker_pool* pool, pool_job job, void* arg) -> void
+ *      Starts a job and waits for it to finish
+ *
+ *  - poolDestroy(worker_pool* pool) -> void
+ *      Tells the workers to exit and joins them
+ *
+ *  - poolWorker(void* arg) -> void*
+ *      Pthread function
+ *      What every worker executes: waits for a job, runs it, repeats
+ *
+ *  - chunkStart(int rank, int thread_count, size_t n) -> size_t
+ *      Where rank's chunk starts when n elements are split among thread_count threads
+ */
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+//the work handed to the pool, called once by every worker with its rank
+typedef void (*pool_job)(int rank, void* arg);
+
+typedef struct {
+    pthread_t* handles;
+    int thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t jobReady;
+    pthread_cond_t jobDone;
+    unsigned long generation; //bumped every time a new job is started
+    int running; //workers that haven't finished the current job
+    bool shutdown;
+    pool_job job;
+    void* arg;
+} worker_pool;
+
+//data for each worker thread
+typedef struct {
+    worker_pool* pool;
+    int rank;
+} pool_worker_data;
+
+/**
+ * Pthread Function
+ *
+ * Parks until a new job is started (the generation changes), runs it with
+ * this worker's rank and reports back when done. Loops until the pool shuts down
+ *
+ * @param *arg: pointer to the pool and rank of this worker
+ * @return void*
+ */
+static void* poolWorker(void* arg){
+
+    worker_pool* pool = ((pool_worker_data *) arg)->pool;
+    int rank = ((pool_worker_data *) arg)->rank;
+    unsigned long seen = 0;
+    pool_job job;
+    void* jobArg;
+
+    free(arg);
+
+    while (true){
+
+        pthread_mutex_lock(&pool->lock);
+
+        while (!pool->shutdown && pool->generation == seen){
+            pthread_cond_wait(&pool->jobReady, &pool->lock);
+        }//while
+
+        if (pool->shutdown){
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }//if
+
+        seen = pool->generation;
+        job = pool->job;
+        jobArg = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+
+        job(rank, jobArg);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0){
+            pthread_cond_broadcast(&pool->jobDone);
+        }//if
+        pthread_mutex_unlock(&pool->lock);
+
+    }//while
+
+    return NULL;
+
+}//poolWorker
+
+/**
+ * Creates thread_count workers. They wait until the first job is started
+ *
+ * @param pool: the pool to set up
+ * @param thread_count: how many workers to create
+ * @return void
+ */
+static inline void poolInit(worker_pool* pool, int thread_count){
+
+    pool->thread_count = thread_count;
+    pool->generation = 0;
+    pool->running = 0;
+    pool->shutdown = false;
+    pool->job = NULL;
+    pool->arg = NULL;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->jobReady, NULL);
+    pthread_cond_init(&pool->jobDone, NULL);
+
+    pool->handles = malloc(thread_count * sizeof(pthread_t));
+
+    if (pool->handles == NULL){
+        fprintf(stderr, "Couldn't allocate memory for the worker pool\n");
+        exit(EXIT_FAILURE);
+    }//if
+
+    for (int i = 0 ; i < thread_count ; i++){
+
+        pool_worker_data *my_data =
+            (pool_worker_data *) malloc(sizeof(pool_worker_data));
+
+        if (my_data == NULL) {
+            fprintf(stderr, "Couldn't allocate memory for thread arg\n");
+            exit(EXIT_FAILURE);
+        }//if
+
+        my_data->pool = pool;
+        my_data->rank = i;
+        pthread_create(&pool->handles[i], NULL, poolWorker, (void *) my_data);
+
+    }//for
+
+}//poolInit
+
+/**
+ * Waits until every worker has finished the current job (if there is one)
+ *
+ * @param pool: the pool to wait on
+ * @return void
+ */
+static inline void poolWait(worker_pool* pool){
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0){
+        pthread_cond_wait(&pool->jobDone, &pool->lock);
+    }//while
+    pthread_mutex_unlock(&pool->lock);
+
+}//poolWait
+
+/**
+ * Hands a new job to every worker. Does not wait for it to finish, so
+ * the caller can do other work (reading, merging) in the meantime
+ *
+ * @param pool: the pool to run the job on
+ * @param job: function each worker calls with its rank
+ * @param arg: passed to job, shared by all the workers
+ * @return void
+ */
+static inline void poolStart(worker_pool* pool, pool_job job, void* arg){
+
+    //only one job at a time
+    poolWait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->arg = arg;
+    pool->running = pool->thread_count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->jobReady);
+    pthread_mutex_unlock(&pool->lock);
+
+}//poolStart
+
+/**
+ * Starts a job on every worker and waits for it to finish
+ *
+ * @param pool: the pool to run the job on
+ * @param job: function each worker calls with its rank
+ * @param arg: passed to job, shared by all the workers
+ * @return void
+ */
+static inline void poolRun(worker_pool* pool, pool_job job, void* arg){
+    poolStart(pool, job, arg);
+    poolWait(pool);
+}//poolRun
+
+/**
+ * Waits for any running job, then tells the workers to exit and joins them
+ *
+ * @param pool: the pool to tear down
+ * @return void
+ */
+static inline void poolDestroy(worker_pool* pool){
+
+    poolWait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->jobReady);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0 ; i < pool->thread_count ; i++){
+        pthread_join(pool->handles[i], NULL);
+    }//for
+
+    free(pool->handles);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->jobReady);
+    pthread_cond_destroy(&pool->jobDone);
+
+}//poolDestroy
+
+/**
+ * Splits n elements into thread_count chunks whose sizes differ by at most one:
+ * the first n % thread_count chunks get one extra element. Chunk rank covers
+ * [chunkStart(rank), chunkStart(rank + 1)), so rank == thread_count gives n
+ *
+ * @param rank: which chunk
+ * @param thread_count: how many chunks
+ * @param n: how many elements are split up
+ * @return size_t: index of the first element of the chunk
+ */
+static inline size_t chunkStart(int rank, int thread_count, size_t n){
+
+    size_t base = n / thread_count;
+    size_t extra = n % thread_count;
+
+    return rank * base + (((size_t) rank < extra) ? (size_t) rank : extra);
+
+}//chunkStart
+
+#endif